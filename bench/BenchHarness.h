@@ -0,0 +1,87 @@
+#ifndef BENCHHARNESS_H
+#define BENCHHARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Emulated DMG frame: 154 scanlines x 456 cycles
+static constexpr double CYCLES_PER_FRAME = 70224.0;
+
+struct BenchOptions {
+    int warmup = 2;        // Untimed runs before measuring
+    int repetitions = 15;  // Timed runs
+};
+
+// Per-unit time over the timed runs
+struct BenchStats {
+    double median;  // ns per unit
+    double mad;     // Median absolute deviation, ns per unit
+    double min;
+};
+
+// Keep `value` alive without the compiler seeing through it
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+inline BenchStats summarize(const std::vector<double>& samples) {
+    BenchStats stats;
+    stats.median = median(samples);
+    std::vector<double> deviations;
+    for (double sample : samples)
+        deviations.push_back(std::fabs(sample - stats.median));
+    stats.mad = median(deviations);
+    stats.min = *std::min_element(samples.begin(), samples.end());
+    return stats;
+}
+
+// Time `body`, which performs `units` units of work per call (instructions,
+// accesses...). `setup` runs untimed before every call.
+template <typename Setup, typename Body>
+BenchStats measure(const BenchOptions& options, uint64_t units, Setup&& setup, Body&& body) {
+    for (int i = 0; i < options.warmup; i++) {
+        setup();
+        body();
+    }
+
+    std::vector<double> samples;
+    for (int i = 0; i < options.repetitions; i++) {
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto stop = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+        samples.push_back(ns / static_cast<double>(units));
+    }
+    return summarize(samples);
+}
+
+// Tetris.gb and tests/*.gb from the source tree (GB_SOURCE_DIR is set by bench/CMakeLists.txt)
+inline std::vector<std::string> repositoryRoms() {
+    std::vector<std::string> roms;
+    std::filesystem::path root(GB_SOURCE_DIR);
+    if (std::filesystem::exists(root / "Tetris.gb"))
+        roms.push_back((root / "Tetris.gb").string());
+    std::vector<std::string> tests;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(root / "tests", error))
+        if (entry.path().extension() == ".gb")
+            tests.push_back(entry.path().string());
+    std::sort(tests.begin(), tests.end());
+    roms.insert(roms.end(), tests.begin(), tests.end());
+    return roms;
+}
+
+#endif // BENCHHARNESS_H
@@ -0,0 +1,322 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "BenchHarness.h"
+#include "gameboy/GameBoy.h"
+
+// End-to-end throughput: fixed-length headless sessions of each ROM at 1, N/2
+// and N threads, with results written as JSON and checked against a baseline.
+//   macro_bench [--frames N] [--sessions N] [--threads 1,4,8] [--frame-skip N|off]
+//               [--audio off|silent|full] [--json out.json] [--baseline base.json]
+//               [--tolerance 0.05] [rom.gb ...]
+
+namespace {
+
+struct Config {
+    uint64_t frames = 600;         // Emulated frames per session (10 s)
+    int sessions = 4;              // Sessions per thread
+    std::vector<unsigned> threads; // Thread counts, default 1, N/2, N
+    uint32_t frameSkip = 0;        // PPU::setFrameSkip() for every session
+    AudioMode audio = AudioMode::Full;
+    std::string jsonPath;
+    std::string baselinePath;
+    double tolerance = 0.05;       // Allowed relative slowdown
+    std::vector<std::string> roms;
+};
+
+struct Measurement {
+    std::string rom;
+    unsigned threads;
+    double cyclesPerSecond;        // Emulated cycles per wall-clock second, all threads
+    double instancesPerSecondPerCore;
+    long peakRssKiB;
+};
+
+// One headless session from power-on; returns emulated cycles
+uint64_t runSession(const GameBoyState& powerOn, uint64_t cycleBudget, uint32_t frameSkip, AudioMode audio) {
+    auto gameboy = std::make_unique<GameBoy>();
+    gameboy->loadState(powerOn);
+    gameboy->getPPU().setFrameSkip(frameSkip);
+    gameboy->setAudioMode(audio);
+    constexpr uint64_t slice = PPU::CYCLES_PER_LINE;
+    while (gameboy->getCycles() < cycleBudget) {
+        gameboy->runUntil(std::min(cycleBudget, gameboy->getCycles() + slice));
+        // Halted with every interrupt disabled: nothing can wake the CPU
+        if (gameboy->getCPU().isHalted() && !(gameboy->getMemory().readByte(0xFFFF) & 0x1F))
+            break;
+    }
+    return gameboy->getCycles();
+}
+
+// Throughput of `threads` threads running sessions of one ROM
+void runConfiguration(const Config& config, const GameBoyState& powerOn, unsigned threads,
+                      double& cyclesPerSecond, double& instancesPerSecondPerCore) {
+    const uint64_t budget = static_cast<uint64_t>(config.frames * CYCLES_PER_FRAME);
+    std::atomic<uint64_t> cycles{0};
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++)
+        pool.emplace_back([&] {
+            uint64_t local = 0;
+            for (int s = 0; s < config.sessions; s++)
+                local += runSession(powerOn, budget, config.frameSkip, config.audio);
+            cycles += local;
+        });
+    for (auto& thread : pool)
+        thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    cyclesPerSecond = static_cast<double>(cycles) / seconds;
+    instancesPerSecondPerCore = config.sessions / seconds;
+}
+
+// Each configuration runs in a child process, so the peak RSS reported for it
+// is its own rather than the largest of every configuration measured so far
+bool measureRom(const Config& config, const std::string& path, const GameBoyState& powerOn,
+                unsigned threads, Measurement& m) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        std::cerr << "macro_bench: pipe failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    std::fflush(stdout);  // Or the child inherits unwritten output
+    pid_t child = fork();
+    if (child < 0) {
+        std::cerr << "macro_bench: fork failed: " << std::strerror(errno) << std::endl;
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (child == 0) {
+        close(fds[0]);
+        double rates[2];
+        runConfiguration(config, powerOn, threads, rates[0], rates[1]);
+        bool sent = write(fds[1], rates, sizeof(rates)) == static_cast<ssize_t>(sizeof(rates));
+        _exit(sent ? 0 : 1);
+    }
+
+    close(fds[1]);
+    double rates[2];
+    bool received = read(fds[0], rates, sizeof(rates)) == static_cast<ssize_t>(sizeof(rates));
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || !received) {
+        std::cerr << "macro_bench: measurement of " << path << " with " << threads << " threads failed"
+                  << std::endl;
+        return false;
+    }
+
+    m.rom = std::filesystem::path(path).filename().string();
+    m.threads = threads;
+    m.cyclesPerSecond = rates[0];
+    m.instancesPerSecondPerCore = rates[1];
+    m.peakRssKiB = usage.ru_maxrss;  // KiB on Linux
+    return true;
+}
+
+/////////////////////////  JSON  ////////////////////////////////
+
+std::string escape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+void writeJSON(const Config& config, const std::vector<Measurement>& results, std::ostream& out) {
+    out << "{\n  \"frames\": " << config.frames << ",\n  \"sessions\": " << config.sessions
+        << ",\n  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Measurement& m = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"rom\": \"" << escape(m.rom) << "\", \"threads\": " << m.threads
+            << ", \"cycles_per_sec\": " << static_cast<uint64_t>(m.cyclesPerSecond)
+            << ", \"instances_per_sec_per_core\": " << m.instancesPerSecondPerCore
+            << ", \"peak_rss_kib\": " << m.peakRssKiB << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+// Value following "key": in a flat object written by writeJSON
+std::string field(const std::string& object, const std::string& key) {
+    size_t pos = object.find("\"" + key + "\":");
+    if (pos == std::string::npos)
+        return "";
+    pos = object.find_first_not_of(' ', pos + key.size() + 3);
+    if (pos == std::string::npos)
+        return "";
+    if (object[pos] == '"') {
+        std::string value;
+        for (pos++; pos < object.size() && object[pos] != '"'; pos++) {
+            if (object[pos] == '\\' && pos + 1 < object.size())
+                pos++;
+            value += object[pos];
+        }
+        return value;
+    }
+    size_t end = object.find_first_of(",}", pos);
+    return object.substr(pos, end - pos);
+}
+
+bool readBaseline(const std::string& path, std::vector<Measurement>& baseline) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "macro_bench: failed to open baseline " << path << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    size_t pos = text.find("\"results\"");
+    while (pos != std::string::npos && (pos = text.find('{', pos)) != std::string::npos) {
+        size_t end = text.find('}', pos);
+        if (end == std::string::npos)
+            break;
+        std::string object = text.substr(pos, end - pos + 1);
+        Measurement m;
+        m.rom = field(object, "rom");
+        m.threads = static_cast<unsigned>(std::atoi(field(object, "threads").c_str()));
+        m.cyclesPerSecond = std::atof(field(object, "cycles_per_sec").c_str());
+        m.instancesPerSecondPerCore = std::atof(field(object, "instances_per_sec_per_core").c_str());
+        m.peakRssKiB = std::atol(field(object, "peak_rss_kib").c_str());
+        baseline.push_back(m);
+        pos = end + 1;
+    }
+    return true;
+}
+
+// Print every measurement next to its baseline; returns the number of regressions
+int compare(const std::vector<Measurement>& results, const std::vector<Measurement>& baseline,
+            double tolerance) {
+    int regressions = 0;
+    std::printf("\n%-28s %7s %14s %14s %8s\n", "rom", "threads", "baseline c/s", "current c/s", "change");
+    for (const Measurement& m : results) {
+        for (const Measurement& b : baseline) {
+            if (b.rom != m.rom || b.threads != m.threads || b.cyclesPerSecond <= 0)
+                continue;
+            double change = m.cyclesPerSecond / b.cyclesPerSecond - 1.0;
+            bool slower = change < -tolerance;
+            regressions += slower;
+            std::printf("%-28s %7u %14.4g %14.4g %+7.1f%%%s\n", m.rom.c_str(), m.threads,
+                        b.cyclesPerSecond, m.cyclesPerSecond, 100.0 * change, slower ? "  REGRESSION" : "");
+        }
+    }
+    return regressions;
+}
+
+std::vector<unsigned> parseThreads(const std::string& list) {
+    std::vector<unsigned> threads;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+        if (int n = std::atoi(item.c_str()); n > 0)
+            threads.push_back(static_cast<unsigned>(n));
+    return threads;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Config config;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc)
+            config.frames = std::max(1ULL, std::strtoull(argv[++i], nullptr, 10));
+        else if (arg == "--sessions" && i + 1 < argc)
+            config.sessions = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--threads" && i + 1 < argc)
+            config.threads = parseThreads(argv[++i]);
+        else if (arg == "--frame-skip" && i + 1 < argc) {
+            std::string value = argv[++i];
+            config.frameSkip = value == "off" ? PPU::RENDER_OFF : static_cast<uint32_t>(std::atoi(value.c_str()));
+        } else if (arg == "--audio" && i + 1 < argc) {
+            std::string value = argv[++i];
+            config.audio = value == "off" ? AudioMode::Off : value == "silent" ? AudioMode::Silent : AudioMode::Full;
+        } else if (arg == "--json" && i + 1 < argc)
+            config.jsonPath = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc)
+            config.baselinePath = argv[++i];
+        else if (arg == "--tolerance" && i + 1 < argc)
+            config.tolerance = std::atof(argv[++i]);
+        else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Usage: macro_bench [--frames N] [--sessions N] [--threads 1,4,8] [--frame-skip N|off]\n"
+                         "                   [--audio off|silent|full] [--json out.json] [--baseline base.json]\n"
+                         "                   [--tolerance 0.05] [rom.gb ...]"
+                      << std::endl;
+            return 1;
+        } else
+            config.roms.push_back(arg);
+    }
+    if (config.roms.empty())
+        config.roms = repositoryRoms();
+    if (config.threads.empty()) {
+        unsigned n = std::max(1u, std::thread::hardware_concurrency());
+        config.threads.push_back(1);
+        if (n / 2 > 1)
+            config.threads.push_back(n / 2);
+        if (n > 1)
+            config.threads.push_back(n);
+    }
+
+    std::vector<Measurement> results;
+    std::printf("%-28s %7s %14s %16s %12s\n", "rom", "threads", "cycles/s", "instances/s/core", "peak RSS");
+    for (const std::string& path : config.roms) {
+        // Power-on state of the cartridge, loaded whole into every session
+        auto gameboy = std::make_unique<GameBoy>();
+        if (!gameboy->loadROM(path))
+            continue;
+        GameBoyState powerOn;
+        gameboy->saveState(powerOn);
+
+        for (unsigned threads : config.threads) {
+            Measurement m;
+            if (!measureRom(config, path, powerOn, threads, m))
+                continue;
+            std::printf("%-28s %7u %14.4g %16.2f %9ld KiB\n", m.rom.c_str(), m.threads,
+                        m.cyclesPerSecond, m.instancesPerSecondPerCore, m.peakRssKiB);
+            std::fflush(stdout);
+            results.push_back(m);
+        }
+    }
+
+    if (!config.jsonPath.empty()) {
+        std::ofstream out(config.jsonPath);
+        if (!out.is_open()) {
+            std::cerr << "macro_bench: failed to open " << config.jsonPath << std::endl;
+            return 1;
+        }
+        writeJSON(config, results, out);
+    }
+
+    if (!config.baselinePath.empty()) {
+        std::vector<Measurement> baseline;
+        if (!readBaseline(config.baselinePath, baseline))
+            return 1;
+        int regressions = compare(results, baseline, config.tolerance);
+        if (regressions) {
+            std::printf("\n%d measurement(s) slower than the baseline by more than %.1f%%\n",
+                        regressions, 100.0 * config.tolerance);
+            return 2;
+        }
+        std::printf("\nNo regressions beyond %.1f%%\n", 100.0 * config.tolerance);
+    }
+    return 0;
+}
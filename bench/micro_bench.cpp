@@ -0,0 +1,355 @@
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BenchHarness.h"
+#include "cpu/CPU.h"
+#include "cpu/CPURegisters.h"
+#include "memory/Memory.h"
+#include "ppu/PPU.h"
+#include "profile/ProfileReport.h"
+
+// Microbenchmarks for the CPU dispatch, register file, memory and stack paths,
+// plus the full instruction mix of real ROMs. Run from the build directory:
+//   micro_bench [--reps N] [--warmup N] [--filter text] [--instructions N] [rom.gb ...]
+
+namespace {
+
+struct Machine {
+    Memory memory;
+    CPURegisters registers;
+    CPU cpu{&memory, &registers};
+};
+
+struct Result {
+    std::string name;
+    BenchStats stats;
+    double cyclesPerUnit;  // Emulated cycles per instruction, 0 for non-CPU benchmarks
+};
+
+struct Config {
+    BenchOptions options;
+    std::string filter;
+    uint64_t instructions = 1 << 20;
+    std::vector<std::string> roms;
+};
+
+std::vector<Result> results;
+
+bool selected(const Config& config, const std::string& name) {
+    return config.filter.empty() || name.find(config.filter) != std::string::npos;
+}
+
+void report(const Result& result) {
+    const BenchStats& s = result.stats;
+    std::printf("%-32s %9.2f ns  +- %6.2f", result.name.c_str(), s.median, s.mad);
+    if (result.cyclesPerUnit > 0) {
+        double mips = 1000.0 / s.median;
+        double fps = mips * 1e6 * result.cyclesPerUnit / CYCLES_PER_FRAME;
+        std::printf("  %9.1f MIPS  %9.0f fps", mips, fps);
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+    results.push_back(result);
+}
+
+/////////////////////////  Synthetic programs  ////////////////////////////////
+
+// Fill ROM from 0x0100 with `pattern` repeated, closed by JP 0x0100, so the
+// CPU runs the pattern in a loop. Returns instructions per loop.
+int loopProgram(Memory& memory, const std::vector<uint8_t>& pattern, int instructionsPerPattern) {
+    const int bytes = 1024;
+    int copies = bytes / static_cast<int>(pattern.size());
+    uint16_t address = 0x0100;
+    for (int i = 0; i < copies; i++)
+        for (uint8_t byte : pattern)
+            memory.writeByte(address++, byte);
+    memory.writeByte(address++, 0xC3);
+    memory.writeByte(address++, 0x00);
+    memory.writeByte(address++, 0x01);
+    return copies * instructionsPerPattern + 1;
+}
+
+void seedRegisters(Machine& m) {
+    m.cpu.reset();
+    m.registers.setHL(0xC000);  // (HL) operands point at work RAM
+    m.registers.setSP(0xDFFE);
+}
+
+void runProgram(const Config& config, const std::string& name,
+                const std::vector<uint8_t>& pattern, int instructionsPerPattern) {
+    if (!selected(config, name))
+        return;
+    auto m = std::make_unique<Machine>();
+    loopProgram(m->memory, pattern, instructionsPerPattern);
+    uint64_t n = config.instructions;
+    uint64_t startCycles = 0;
+
+    BenchStats stats = measure(config.options, n,
+        [&] { seedRegisters(*m); startCycles = m->cpu.getCycles(); },
+        [&] { for (uint64_t i = 0; i < n; i++) m->cpu.step(); });
+    double cycles = static_cast<double>(m->cpu.getCycles() - startCycles) / static_cast<double>(n);
+    report({name, stats, cycles});
+}
+
+// Single-byte opcodes that can run back to back without leaving the loop
+std::vector<uint8_t> handlerOpcodes() {
+    std::vector<uint8_t> ops = {0x00, 0x07, 0x0F, 0x17, 0x1F, 0x27, 0x2F, 0x37, 0x3F};
+    for (int rr = 0; rr < 4; rr++) {
+        ops.push_back(static_cast<uint8_t>(0x03 + rr * 0x10));  // INC rr
+        ops.push_back(static_cast<uint8_t>(0x0B + rr * 0x10));  // DEC rr
+    }
+    for (int r = 0; r < 8; r++) {
+        ops.push_back(static_cast<uint8_t>(0x04 + r * 8));      // INC r
+        ops.push_back(static_cast<uint8_t>(0x05 + r * 8));      // DEC r
+    }
+    for (int op = 0x40; op < 0xC0; op++)
+        if (op != 0x76)                                         // LD r,r / ALU A,r
+            ops.push_back(static_cast<uint8_t>(op));
+    return ops;
+}
+
+void benchDispatch(const Config& config) {
+    for (uint8_t op : handlerOpcodes()) {
+        char name[48];
+        std::snprintf(name, sizeof(name), "dispatch/%02X %s", op, opcodeMnemonic(op));
+        runProgram(config, name, {op}, 1);
+    }
+    runProgram(config, "dispatch/LD B,d8", {0x06, 0x12}, 1);
+    runProgram(config, "dispatch/LD BC,d16", {0x01, 0x34, 0x12}, 1);
+    runProgram(config, "dispatch/JR +0", {0x18, 0x00}, 1);
+    runProgram(config, "dispatch/CB SWAP A", {0xCB, 0x37}, 1);
+}
+
+void benchStack(const Config& config) {
+    runProgram(config, "stack/PUSH BC; POP BC", {0xC5, 0xC1}, 2);
+    runProgram(config, "stack/PUSH+POP all pairs", {0xC5, 0xD5, 0xE5, 0xF5, 0xF1, 0xE1, 0xD1, 0xC1}, 8);
+
+    // CALL a subroutine that returns immediately
+    const std::string name = "stack/CALL; RET";
+    if (!selected(config, name))
+        return;
+    auto m = std::make_unique<Machine>();
+    const uint8_t program[] = {0xCD, 0x00, 0x02, 0xC3, 0x00, 0x01};  // CALL 0x0200; JP 0x0100
+    for (int i = 0; i < 6; i++)
+        m->memory.writeByte(static_cast<uint16_t>(0x0100 + i), program[i]);
+    m->memory.writeByte(0x0200, 0xC9);                                 // RET
+    uint64_t n = config.instructions;
+    uint64_t startCycles = 0;
+    BenchStats stats = measure(config.options, n,
+        [&] { seedRegisters(*m); startCycles = m->cpu.getCycles(); },
+        [&] { for (uint64_t i = 0; i < n; i++) m->cpu.step(); });
+    report({name, stats, static_cast<double>(m->cpu.getCycles() - startCycles) / static_cast<double>(n)});
+}
+
+/////////////////////////  Components  ////////////////////////////////
+
+void benchRegisters(const Config& config) {
+    const std::string name = "registers/get+set mix";
+    if (!selected(config, name))
+        return;
+    CPURegisters r;
+    const uint64_t n = config.instructions * 4;
+    // Four register-file operations per iteration
+    BenchStats stats = measure(config.options, n * 4,
+        [&] { r.setAF(0x01B0); r.setBC(0x0013); r.setDE(0x00D8); r.setHL(0x014D); },
+        [&] {
+            for (uint64_t i = 0; i < n; i++) {
+                r.setBC(static_cast<uint16_t>(r.getBC() + 1));
+                r.setA(r.getA() ^ r.getB());
+                r.setFlagZ(r.getA() == 0);
+                r.setHL(static_cast<uint16_t>(r.getHL() + r.getDE()));
+                doNotOptimize(r);
+            }
+        });
+    report({name, stats, 0});
+}
+
+std::vector<uint16_t> randomAddresses(size_t count, uint16_t base, uint16_t span) {
+    std::vector<uint16_t> addresses(count);
+    uint32_t state = 0x12345678;
+    for (auto& address : addresses) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        address = static_cast<uint16_t>(base + state % span);
+    }
+    return addresses;
+}
+
+void benchMemory(const Config& config) {
+    auto memory = std::make_unique<Memory>();
+    const std::vector<uint16_t> anywhere = randomAddresses(1 << 16, 0x0000, 0xFFFF);
+    const std::vector<uint16_t> ram = randomAddresses(1 << 16, 0xC000, 0x2000);
+    const uint64_t passes = config.instructions >> 14 ? config.instructions >> 14 : 1;
+    const uint64_t n = passes * anywhere.size();
+
+    if (selected(config, "memory/readByte sequential")) {
+        BenchStats stats = measure(config.options, n, [] {}, [&] {
+            uint32_t sum = 0;
+            for (uint64_t p = 0; p < passes; p++)
+                for (uint32_t a = 0; a < 0x10000; a++)
+                    sum += memory->readByte(static_cast<uint16_t>(a));
+            doNotOptimize(sum);
+        });
+        report({"memory/readByte sequential", stats, 0});
+    }
+    if (selected(config, "memory/readByte random")) {
+        BenchStats stats = measure(config.options, n, [] {}, [&] {
+            uint32_t sum = 0;
+            for (uint64_t p = 0; p < passes; p++)
+                for (uint16_t address : anywhere)
+                    sum += memory->readByte(address);
+            doNotOptimize(sum);
+        });
+        report({"memory/readByte random", stats, 0});
+    }
+    if (selected(config, "memory/writeByte random WRAM")) {
+        BenchStats stats = measure(config.options, n, [] {}, [&] {
+            for (uint64_t p = 0; p < passes; p++)
+                for (uint16_t address : ram)
+                    memory->writeByte(address, static_cast<uint8_t>(address));
+            doNotOptimize(*memory);
+        });
+        report({"memory/writeByte random WRAM", stats, 0});
+    }
+}
+
+// Full frames of background + window + 10 sprites per line from random VRAM
+// With rewriteTiles every tile is written once per frame, so the tile cache
+// decodes all 384 tiles each frame (the worst case). With an observation spec
+// lines are downscaled into an observation buffer instead of the frame buffer.
+void benchPPU(const Config& config, const std::string& name, bool rewriteTiles,
+              const ObservationSpec* spec = nullptr) {
+    if (!selected(config, name))
+        return;
+    auto memory = std::make_unique<Memory>();
+    std::vector<uint16_t> noise = randomAddresses(0x2000 + 0xA0, 0, 0xFFFF);
+    for (int i = 0; i < 0x2000; i++)
+        memory->writeByte(static_cast<uint16_t>(0x8000 + i), static_cast<uint8_t>(noise[i]));
+    for (int i = 0; i < 40; i++) {
+        memory->writeByte(static_cast<uint16_t>(0xFE00 + i * 4), static_cast<uint8_t>(16 + (i * 37) % 144));
+        memory->writeByte(static_cast<uint16_t>(0xFE01 + i * 4), static_cast<uint8_t>(8 + (i * 53) % 160));
+        memory->writeByte(static_cast<uint16_t>(0xFE02 + i * 4), static_cast<uint8_t>(noise[0x2000 + i]));
+        memory->writeByte(static_cast<uint16_t>(0xFE03 + i * 4), static_cast<uint8_t>(noise[0x2050 + i] & 0xF0));
+    }
+    memory->writeByte(0xFF40, 0xE3);  // LCD, BG, window (0x9C00), sprites on
+    memory->writeByte(0xFF43, 3);
+    memory->writeByte(0xFF47, 0xE4);
+    memory->writeByte(0xFF4A, 72);
+    memory->writeByte(0xFF4B, 87);
+
+    auto ppu = std::make_unique<PPU>(memory.get());
+    std::vector<uint8_t> observation;
+    if (spec) {
+        observation.resize(ObservationWriter::bufferBytes(*spec));
+        ppu->setObservation(*spec, observation.data());
+    }
+    const uint64_t frames = std::max<uint64_t>(1, config.instructions >> 12);
+    BenchStats stats = measure(config.options, frames * PPU::SCREEN_HEIGHT, [] {}, [&] {
+        for (uint64_t f = 0; f < frames; f++) {
+            if (rewriteTiles)
+                for (int t = 0; t < Memory::VRAM_TILES; t++)
+                    memory->writeByte(static_cast<uint16_t>(0x8000 + t * 16 + (f & 15)), static_cast<uint8_t>(f + t));
+            for (int line = 0; line < PPU::SCREEN_HEIGHT; line++)
+                ppu->renderScanline(line);
+        }
+        doNotOptimize(ppu->frameBuffer()[0]);
+    });
+    report({name, stats, 0});
+    std::printf("%-32s %9.0f frames/s rendered\n", "", 1e9 / (stats.median * PPU::SCREEN_HEIGHT));
+}
+
+/////////////////////////  ROM instruction mix  ////////////////////////////////
+
+void benchRom(const Config& config, const std::string& path) {
+    std::string name = "rom/" + std::filesystem::path(path).filename().string();
+    if (!selected(config, name))
+        return;
+
+    auto image = std::make_unique<Memory>();
+    if (!image->loadROM(path))
+        return;
+    std::vector<uint8_t> initial(Memory::MEMORY_SIZE);
+    image->saveState(initial.data());
+
+    // Dry run: the instruction count is fixed by the ROM, the CPU may halt early
+    auto m = std::make_unique<Machine>();
+    m->memory.loadState(initial.data());
+    m->cpu.reset();
+    uint64_t executed = 0;
+    while (executed < config.instructions && !m->cpu.saveState().halted) {
+        m->cpu.step();
+        executed++;
+    }
+    if (executed == 0)
+        return;
+    double cyclesPerInstruction = static_cast<double>(m->cpu.getCycles()) / static_cast<double>(executed);
+
+    BenchStats stats = measure(config.options, executed,
+        [&] { m->memory.loadState(initial.data()); m->cpu.reset(); },
+        [&] { for (uint64_t i = 0; i < executed; i++) m->cpu.step(); });
+    report({name, stats, cyclesPerInstruction});
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Config config;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--reps" && i + 1 < argc)
+            config.options.repetitions = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--warmup" && i + 1 < argc)
+            config.options.warmup = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--filter" && i + 1 < argc)
+            config.filter = argv[++i];
+        else if (arg == "--instructions" && i + 1 < argc)
+            config.instructions = std::max(1ULL, std::strtoull(argv[++i], nullptr, 10));
+        else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Usage: micro_bench [--reps N] [--warmup N] [--filter text] "
+                         "[--instructions N] [rom.gb ...]" << std::endl;
+            return 1;
+        } else
+            config.roms.push_back(arg);
+    }
+    if (config.roms.empty())
+        config.roms = repositoryRoms();
+
+    std::printf("%-32s %12s  %9s  %14s  %13s\n", "benchmark", "median/unit", "MAD", "speed", "emulated");
+    std::printf("(%d warmup, %d repetitions, %llu instructions per run)\n",
+                config.options.warmup, config.options.repetitions,
+                static_cast<unsigned long long>(config.instructions));
+
+    benchDispatch(config);
+    benchStack(config);
+    benchRegisters(config);
+    benchMemory(config);
+    ObservationSpec luminance84;
+    ObservationSpec shades80;
+    shades80.width = 80;
+    shades80.height = 72;
+    shades80.format = ObservationSpec::SHADE_INDEX;
+    benchPPU(config, "ppu/frame, tiles unchanged", false);
+    benchPPU(config, "ppu/frame, all tiles rewritten", true);
+    benchPPU(config, "ppu/observation 84x84 luminance", false, &luminance84);
+    benchPPU(config, "ppu/observation 80x72 shades", false, &shades80);
+    for (const std::string& rom : config.roms)
+        benchRom(config, rom);
+
+    // Mean over the per-handler loops, the figure to watch for dispatch changes
+    double sum = 0;
+    int count = 0;
+    for (const Result& result : results)
+        if (result.name.rfind("dispatch/", 0) == 0) {
+            sum += result.stats.median;
+            count++;
+        }
+    if (count)
+        std::printf("\ndispatch mean over %d handlers: %.2f ns/instruction\n", count, sum / count);
+    return 0;
+}
@@ -1,35 +1,166 @@
-#include <iostream>
-#include "memory/Memory.h"
-#include "cpu/CPU.h"
-#include "cpu/CPURegisters.h"
-
-int main(int argc, char* argv[])
-{
-    if (argc < 2) {
-        std::cerr << "Usage: gb_emulator <path to rom.gb>" << std::endl;
-        return 1;
-    }
-
-    std::string romPath = argv[1];
-    
-    CPURegisters regs;
-    
-    Memory memory;
-    if (!memory.loadROM(romPath)) {
-        std::cerr << "Failed to load ROM from " << romPath << std::endl;
-        return 1;
-    }
-    
-
-    CPU cpu(&memory,&regs);
-
-    constexpr int stepsToRun = 1000;
-
-    for (int i = 0; i < stepsToRun; i++) {
-        cpu.step();
-    }
-
-    std::cout << "Ran " << stepsToRun << " CPU steps successfully." << std::endl;
-
-    return 0;
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include "gameboy/GameBoy.h"
+#include "trace/ColumnarTrace.h"
+#include "trace/DiffTrace.h"
+#include "trace/TraceReplay.h"
+#include "profile/PerfCounters.h"
+#include "profile/ProfileReport.h"
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Usage: gb_emulator [--trace <out.trace>] [--trace-format columnar|diff|raw]\n"
+                  << "                   [--trace-filter <spec>] [--profile table|json]\n"
+                  << "                   [--perf] [--steps N] [--frame-skip N|off] [--audio off|silent|full]\n"
+                  << "                   <path to rom.gb>\n"
+                  << "       gb_emulator --replay <in.trace> [--threads N]"
+                  << std::endl;
+        return 1;
+    }
+
+    std::string romPath;
+    std::string tracePath;
+    std::string traceFormat = "columnar";
+    std::string traceFilter;
+    std::string replayPath;
+    std::string profileFormat;
+    bool perfCounters = false;
+    int stepsToRun = 1000;
+    uint32_t frameSkip = 0;
+    AudioMode audio = AudioMode::Full;
+    unsigned threads = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (arg == "--trace-format" && i + 1 < argc)
+            traceFormat = argv[++i];
+        else if (arg == "--trace-filter" && i + 1 < argc)
+            traceFilter = argv[++i];
+        else if (arg == "--profile" && i + 1 < argc)
+            profileFormat = argv[++i];
+        else if (arg == "--perf")
+            perfCounters = true;
+        else if (arg == "--steps" && i + 1 < argc)
+            stepsToRun = std::max(0, std::atoi(argv[++i]));
+        else if (arg == "--frame-skip" && i + 1 < argc) {
+            std::string value = argv[++i];
+            frameSkip = value == "off" ? PPU::RENDER_OFF : static_cast<uint32_t>(std::stoul(value));
+        }
+        else if (arg == "--audio" && i + 1 < argc) {
+            std::string value = argv[++i];
+            audio = value == "off" ? AudioMode::Off : value == "silent" ? AudioMode::Silent : AudioMode::Full;
+        }
+        else if (arg == "--replay" && i + 1 < argc)
+            replayPath = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc)
+            threads = static_cast<unsigned>(std::stoul(argv[++i]));
+        else
+            romPath = arg;
+    }
+
+    // Re-execute a state-diff trace and verify every recorded instruction
+    if (!replayPath.empty()) {
+        ReplayOptions options;
+        options.threads = threads;
+        TraceReplayer replayer(options);
+        ReplayResult result = replayer.run(replayPath);
+        if (result.diverged)
+            TraceReplayer::describe(result.divergence, std::cerr);
+        std::cout << "Verified " << result.recordsVerified << " records in " << result.segments
+                  << " segments" << (result.ok ? "" : " (FAILED)") << std::endl;
+        return result.ok ? 0 : 1;
+    }
+    
+    auto gameboy = std::make_unique<GameBoy>();
+    if (!gameboy->loadROM(romPath)) {
+        std::cerr << "Failed to load ROM from " << romPath << std::endl;
+        return 1;
+    }
+
+    PPU& ppu = gameboy->getPPU();
+    ppu.setFrameSkip(frameSkip);
+    gameboy->setAudioMode(audio);
+
+#ifdef GB_TRACE
+    // Records are written on a background thread while the CPU runs
+    CPU& cpu = gameboy->getCPU();
+    std::unique_ptr<TraceWriter> traceWriter;
+    if (!tracePath.empty()) {
+        if (!traceFilter.empty()) {
+            TraceFilter filter;
+            // A diff trace must see every instruction to stay replayable
+            if (traceFormat == "diff") {
+                std::cerr << "--trace-filter cannot be used with the diff trace format" << std::endl;
+                return 1;
+            }
+            if (!filter.compile(traceFilter))
+                return 1;
+            cpu.tracer().setFilter(filter);
+        }
+
+        bool opened;
+        if (traceFormat == "diff") {
+            auto writer = std::make_unique<DiffTraceWriter>();
+            opened = writer->open(tracePath, gameboy->getMemory());
+            traceWriter = std::move(writer);
+        } else if (traceFormat == "raw") {
+            traceWriter = std::make_unique<TraceWriter>();
+            opened = traceWriter->open(tracePath);
+        } else {
+            traceWriter = std::make_unique<ColumnarTraceWriter>();
+            opened = traceWriter->open(tracePath);
+        }
+        if (!opened)
+            return 1;
+        traceWriter->attach(cpu.tracer());
+    }
+#else
+    if (!tracePath.empty())
+        std::cerr << "Tracing is not compiled in, reconfigure with -DGB_TRACE=ON" << std::endl;
+#endif
+
+    // Host counters are read once per quantum, not per instruction
+    PerfCounters perf;
+    PerfCounters* counters = perfCounters && perf.open() ? &perf : nullptr;
+    gameboy->setPerfCounters(counters);
+    constexpr int quantum = 4096;
+
+    for (int done = 0; done < stepsToRun;) {
+        int n = std::min(quantum, stepsToRun - done);
+        PerfScope scope(counters, PerfPhase::Cpu);
+        for (int i = 0; i < n; i++)
+            gameboy->step();
+        scope.setEmulated(n);
+        done += n;
+    }
+
+#ifdef GB_TRACE
+    if (traceWriter) {
+        PerfScope scope(counters, PerfPhase::Trace);
+        if (!traceWriter->close())
+            return 1;
+        std::cout << "Wrote " << traceWriter->recordsWritten() << " trace records to " << tracePath << std::endl;
+    }
+#endif
+
+    std::cout << "Ran " << stepsToRun << " CPU steps successfully (" << ppu.getFrames() << " frames)." << std::endl;
+
+    if (counters)
+        counters->report(std::cout);
+
+    if (!profileFormat.empty()) {
+#ifdef GB_PROFILE
+        if (profileFormat == "json")
+            writeProfileJSON(gameboy->getCPU().profiler().getCounters(), std::cout);
+        else
+            printProfileTable(gameboy->getCPU().profiler().getCounters(), std::cout);
+#else
+        std::cerr << "Profiling is not compiled in, reconfigure with -DGB_PROFILE=ON" << std::endl;
+#endif
+    }
+
+    return 0;
 }
\ No newline at end of file
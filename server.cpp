@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "env/VecEnv.h"
+#include "ipc/SharedChannel.h"
+
+// Emulator server for out-of-process trainers. Each channel is a VecEnv of
+// --envs instances behind a shared-memory segment /dev/shm/<name>-<channel>
+// that one trainer at a time attaches to with SharedChannel::open().
+
+static std::atomic<bool> stopping{false};
+
+static void requestStop(int) {
+    stopping = true;
+}
+
+static std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, separator))
+        parts.push_back(part);
+    return parts;
+}
+
+// Serve one channel until the server is stopped
+static void serve(SharedChannel& channel, VecEnv& env) {
+    uint32_t served = channel.info().request.load();
+    while (!stopping) {
+        uint32_t request;
+        if (!channel.waitRequest(served, request, 100)) {
+            channel.releaseDeadTrainer();
+            continue;
+        }
+        served = request;
+
+        bool ok;
+        switch (channel.info().command) {
+            case ChannelCommand::Reset:
+                ok = env.reset(channel.observations());
+                break;
+            case ChannelCommand::Step:
+                ok = env.step(channel.actions(), channel.observations(), channel.rewards(), channel.dones());
+                break;
+            default:
+                ok = false;
+                break;
+        }
+        channel.respond(request, ok ? 0 : 1);
+    }
+}
+
+static int usage() {
+    std::cerr << "Usage: gb_server [--name gbemu] [--channels N] [--envs N] [--frames-per-step N]\n"
+                 "                 [--threads N] [--size 84x84] [--stack N] [--max-frames N]\n"
+                 "                 [--reward EXPR] [--done EXPR] (RAM expressions, see RamExpression.h)\n"
+                 "                 <path to rom.gb>"
+              << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    std::string name = "gbemu";
+    std::string romPath;
+    unsigned channels = 1;
+    VecEnvConfig config;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool parsed = true;
+        if (arg == "--name" && i + 1 < argc)
+            name = argv[++i];
+        else if (arg == "--channels" && i + 1 < argc)
+            channels = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        else if (arg == "--envs" && i + 1 < argc)
+            config.envs = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        else if (arg == "--frames-per-step" && i + 1 < argc)
+            config.framesPerStep = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+        else if (arg == "--threads" && i + 1 < argc)
+            config.threads = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        else if (arg == "--size" && i + 1 < argc) {
+            std::vector<std::string> size = split(argv[++i], 'x');
+            parsed = size.size() == 2;
+            if (parsed) {
+                config.observation.width = std::atoi(size[0].c_str());
+                config.observation.height = std::atoi(size[1].c_str());
+            }
+        } else if (arg == "--stack" && i + 1 < argc)
+            config.observation.stack = std::atoi(argv[++i]);
+        else if (arg == "--max-frames" && i + 1 < argc)
+            config.maxEpisodeFrames = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--reward" && i + 1 < argc)
+            config.reward = argv[++i];
+        else if (arg == "--done" && i + 1 < argc)
+            config.done = argv[++i];
+        else if (arg.rfind("--", 0) == 0)
+            parsed = false;
+        else
+            romPath = arg;
+
+        if (!parsed)
+            return usage();
+    }
+    if (romPath.empty())
+        return usage();
+
+    // Every channel gets its own instances and worker threads
+    std::vector<std::unique_ptr<VecEnv>> envs;
+    std::vector<std::unique_ptr<SharedChannel>> links;
+    for (unsigned c = 0; c < channels; c++) {
+        auto env = std::make_unique<VecEnv>();
+        if (!env->open(romPath, config))
+            return 1;
+        auto channel = std::make_unique<SharedChannel>();
+        const ObservationSpec& spec = config.observation;
+        std::string segment = "/" + name + "-" + std::to_string(c);
+        if (!channel->create(segment, static_cast<uint32_t>(env->size()), spec.width, spec.height, spec.stack))
+            return 1;
+        std::cout << "Serving " << env->size() << " instances on " << segment << std::endl;
+        envs.push_back(std::move(env));
+        links.push_back(std::move(channel));
+    }
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    std::vector<std::thread> servers;
+    for (unsigned c = 0; c < channels; c++)
+        servers.emplace_back(serve, std::ref(*links[c]), std::ref(*envs[c]));
+    for (std::thread& server : servers)
+        server.join();
+    return 0;
+}
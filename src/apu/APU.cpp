@@ -0,0 +1,560 @@
+#include "APU.h"
+#include <algorithm>
+
+static constexpr uint16_t NR10 = 0xFF10;
+static constexpr uint16_t NR13 = 0xFF13;
+static constexpr uint16_t NR14 = 0xFF14;
+static constexpr uint16_t NR32 = 0xFF1C;
+static constexpr uint16_t NR43 = 0xFF22;
+static constexpr uint16_t NR50 = 0xFF24;
+static constexpr uint16_t NR51 = 0xFF25;
+static constexpr uint16_t NR52 = 0xFF26;
+static constexpr uint16_t WAVE_RAM = 0xFF30;
+
+// NRx1 of each channel; NRx2-NRx4 follow it
+static constexpr uint16_t NRX1[4] = {0xFF11, 0xFF16, 0xFF1B, 0xFF20};
+
+static constexpr uint16_t LENGTH_MAX[4] = {64, 64, 256, 64};
+
+// Bits that read back as 1 in 0xFF10-0xFF2F (write-only and unused bits)
+static constexpr uint8_t READ_MASK[0x20] = {
+    0x80, 0x3F, 0x00, 0xFF, 0xBF,   // NR10-NR14
+    0xFF, 0x3F, 0x00, 0xFF, 0xBF,   // NR20-NR24
+    0x7F, 0xFF, 0x9F, 0xFF, 0xBF,   // NR30-NR34
+    0xFF, 0xFF, 0x00, 0x00, 0xBF,   // NR40-NR44
+    0x00, 0x00, 0x70,               // NR50-NR52
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+// Register values the boot ROM leaves behind (0xFF10-0xFF25)
+static constexpr uint8_t POWER_ON[0x16] = {
+    0x80, 0xBF, 0xF3, 0xFF, 0xBF,
+    0xFF, 0x3F, 0x00, 0xFF, 0xBF,
+    0x7F, 0xFF, 0x9F, 0xFF, 0xBF,
+    0xFF, 0xFF, 0x00, 0x00, 0xBF,
+    0x77, 0xF3
+};
+
+// Pulse waveforms, bit n = duty step n (12.5%, 25%, 50%, 75%)
+static constexpr uint8_t DUTY[4] = {0x80, 0x81, 0xE1, 0x7E};
+
+// Right shift of wave samples for NR32 volume codes 0-3 (mute, 100%, 50%, 25%)
+static constexpr uint8_t WAVE_SHIFT[4] = {4, 0, 1, 2};
+
+// Step size of one level unit at master volume 1, so the loudest mix (four
+// channels at 15, volume 8) stays inside 16 bits
+static constexpr float OUTPUT_SCALE = 64.0f;
+
+// Period used while the noise clock is stopped (NR43 shift 14-15)
+static constexpr uint32_t STOPPED_PERIOD = 1u << 30;
+
+APU::APU(Memory* mem, const CPU* cpu) : memory(mem), cpu(cpu) {
+    setSampleRate(sampleRate);
+}
+
+void APU::setMode(AudioMode newMode) {
+    if (newMode == mode)
+        return;
+    const uint64_t cycle = now();
+    if (mode == AudioMode::Off) {
+        // Carry on from the current cycle; nothing ran while the APU was off
+        for (uint16_t address = NR10; address < WAVE_RAM; address++)
+            memory->setIoHandler(address, readRegister, writeRegister, this);
+        synced = cycle;
+        nextTick = (cycle / SEQUENCER_PERIOD + 1) * SEQUENCER_PERIOD;
+    } else {
+        sync();
+        if (newMode == AudioMode::Off)
+            for (uint16_t address = NR10; address < WAVE_RAM; address++)
+                memory->setIoHandler(address, nullptr, nullptr, nullptr);
+    }
+    mode = newMode;
+
+    // Waveforms did not advance outside Full mode
+    if (mode == AudioMode::Full) {
+        for (ApuChannel& ch : channels)
+            ch.nextEdge = std::max(ch.nextEdge, cycle);
+        restartOutput(cycle);
+    }
+}
+
+void APU::setEventHook(EventHook hook, void* context) {
+    eventHook = hook;
+    eventContext = context;
+}
+
+uint64_t APU::nextEventTime() const {
+    if (mode == AudioMode::Full)
+        return nextTick;
+    uint64_t next = UINT64_MAX;
+    if (mode == AudioMode::Off || !powered)
+        return next;
+
+    // The step an enabled channel's length runs out on (lengths clock on even steps)
+    const uint64_t firstLength = nextTick + (sequencerStep & 1) * SEQUENCER_PERIOD;
+    for (int c = 0; c < 4; c++) {
+        const ApuChannel& ch = channels[c];
+        if (ch.enabled && ch.length && (reg(NRX1[c] + 3) & 0x40))
+            next = std::min(next, firstLength + 2 * SEQUENCER_PERIOD * (ch.length - 1u));
+    }
+    // The next sweep calculation, which may overflow (sweep clocks on steps 2 and 6)
+    if (channels[0].enabled && sweepEnabled && (reg(NR10) & 0x70)) {
+        uint64_t firstSweep = nextTick + ((2 - sequencerStep) & 3) * SEQUENCER_PERIOD;
+        next = std::min(next, firstSweep + 4 * SEQUENCER_PERIOD * (std::max<uint8_t>(sweepTimer, 1) - 1u));
+    }
+    return next;
+}
+
+void APU::reset() {
+    const uint64_t cycle = now();
+    for (ApuChannel& ch : channels)
+        ch = ApuChannel();
+    for (uint16_t address = NR10; address <= NR51; address++)
+        memory->poke(address, POWER_ON[address - NR10]);
+
+    // Channel 1 is still enabled from the boot sound, faded out to volume 0
+    channels[0].enabled = true;
+    channels[0].dacOn = true;
+    for (ApuChannel& ch : channels) {
+        ch.lfsr = 0x7FFF;
+        ch.nextEdge = cycle;
+    }
+    sweepShadow = 0;
+    sweepTimer = 0;
+    sweepEnabled = false;
+    powered = true;
+    sequencerStep = 0;
+    synced = cycle;
+    nextTick = (cycle / SEQUENCER_PERIOD + 1) * SEQUENCER_PERIOD;
+
+    samples.clear();
+    restartOutput(cycle);
+    updateStatus();
+}
+
+bool APU::setSampleRate(uint32_t rate) {
+    // A frame runs from one sequencer step to the next, plus the instruction
+    // that crosses it
+    if (!left.setRates(CLOCK_RATE, rate, 2 * SEQUENCER_PERIOD) ||
+        !right.setRates(CLOCK_RATE, rate, 2 * SEQUENCER_PERIOD))
+        return false;
+    sampleRate = rate;
+    samples.clear();
+    restartOutput(synced);
+    return true;
+}
+
+APUState APU::saveState() const {
+    APUState state;
+    std::copy(channels, channels + 4, state.channels);
+    state.sweepShadow = sweepShadow;
+    state.sweepTimer = sweepTimer;
+    state.sweepEnabled = sweepEnabled;
+    state.powered = powered;
+    state.sequencerStep = sequencerStep;
+    state.synced = synced;
+    state.nextTick = nextTick;
+    return state;
+}
+
+void APU::loadState(const APUState& state) {
+    std::copy(state.channels, state.channels + 4, channels);
+    sweepShadow = state.sweepShadow;
+    sweepTimer = state.sweepTimer;
+    sweepEnabled = state.sweepEnabled;
+    powered = state.powered;
+    sequencerStep = state.sequencerStep;
+    synced = state.synced;
+    nextTick = state.nextTick;
+
+    // Registers must already hold the loaded memory state
+    restartOutput(synced);
+}
+
+size_t APU::readSamples(int16_t* out, size_t frames) {
+    frames = std::min(frames, samplesAvailable());
+    std::copy(samples.begin(), samples.begin() + 2 * frames, out);
+    samples.erase(samples.begin(), samples.begin() + 2 * frames);
+    return frames;
+}
+
+/////////////////////////  Registers  ////////////////////////////////
+
+uint8_t APU::readRegister(void* context, uint16_t address) {
+    APU* apu = static_cast<APU*>(context);
+    // Status bits only change on sequencer steps, which may be due this instruction
+    if (address == NR52)
+        apu->sync();
+    return apu->reg(address) | READ_MASK[address - NR10];
+}
+
+void APU::writeRegister(void* context, uint16_t address, uint8_t value) {
+    APU* apu = static_cast<APU*>(context);
+    apu->sync();
+    apu->write(address, value);
+    if (apu->eventHook)
+        apu->eventHook(apu->eventContext, apu->nextEventTime());
+}
+
+void APU::write(uint16_t address, uint8_t value) {
+    if (address == NR52) {
+        setPower(value & 0x80);
+        return;
+    }
+    // Registers ignore writes while the APU is off; 0xFF27-0xFF2F are unused
+    if (!powered || address > NR51)
+        return;
+    memory->poke(address, value);
+
+    const uint64_t cycle = now();
+    if (address >= NR50) {
+        updateGains(cycle);
+        return;
+    }
+
+    // Each channel has five registers starting at NR10 (channel 4's first is unused)
+    int c = (address - NR10) / 5;
+    ApuChannel& ch = channels[c];
+    switch ((address - NR10) % 5) {
+        case 0:
+            // NR10 sweep settings are read when used; NR30 switches the wave DAC
+            if (c == 2) {
+                ch.dacOn = value & 0x80;
+                if (!ch.dacOn)
+                    disable(c, cycle);
+            }
+            break;
+        case 1:
+            ch.length = LENGTH_MAX[c] - (c == 2 ? value : value & 0x3F);
+            break;
+        case 2:
+            if (c == 2) {
+                setLevel(c, channelOutput(c), cycle);  // Wave volume takes effect at once
+                break;
+            }
+            // Volume 0 with a decreasing envelope switches the DAC off
+            ch.dacOn = value & 0xF8;
+            if (!ch.dacOn)
+                disable(c, cycle);
+            break;
+        case 3:
+            if (c == 3)
+                ch.nextEdge = cycle + period(c);  // New noise clock
+            else
+                ch.frequency = (ch.frequency & 0x700) | value;
+            break;
+        default:
+            if (c != 3)
+                ch.frequency = static_cast<uint16_t>((ch.frequency & 0xFF) | ((value & 7) << 8));
+            if (value & 0x80)
+                trigger(c);
+            break;
+    }
+}
+
+void APU::trigger(int c) {
+    const uint64_t cycle = now();
+    ApuChannel& ch = channels[c];
+    if (ch.length == 0)
+        ch.length = LENGTH_MAX[c];
+    if (c == 2) {
+        ch.position = 0;
+    } else {
+        uint8_t envelope = reg(NRX1[c] + 1);
+        ch.volume = envelope >> 4;
+        ch.envelopeTimer = envelope & 7;
+    }
+    if (c == 3)
+        ch.lfsr = 0x7FFF;
+    ch.nextEdge = cycle + period(c);
+    ch.enabled = ch.dacOn;
+
+    if (c == 0) {
+        uint8_t sweep = reg(NR10);
+        uint8_t sweepPeriod = (sweep >> 4) & 7;
+        sweepShadow = ch.frequency;
+        sweepTimer = sweepPeriod ? sweepPeriod : 8;
+        sweepEnabled = sweepPeriod || (sweep & 7);
+        if ((sweep & 7) && sweepTarget() > 0x7FF)
+            ch.enabled = false;
+    }
+
+    setLevel(c, channelOutput(c), cycle);
+    updateStatus();
+}
+
+void APU::setPower(bool on) {
+    if (on == powered)
+        return;
+    const uint64_t cycle = now();
+    if (!on) {
+        for (uint16_t address = NR10; address <= NR51; address++)
+            memory->poke(address, 0);
+        for (int c = 0; c < 4; c++) {
+            channels[c].enabled = false;
+            channels[c].dacOn = false;
+            setLevel(c, 0, cycle);
+        }
+        sweepEnabled = false;
+        updateGains(cycle);
+    } else {
+        sequencerStep = 0;
+    }
+    powered = on;
+    updateStatus();
+}
+
+void APU::disable(int c, uint64_t cycle) {
+    channels[c].enabled = false;
+    setLevel(c, 0, cycle);
+    updateStatus();
+}
+
+// Keep the NR52 byte current for snapshots and trace keyframes
+void APU::updateStatus() {
+    uint8_t status = powered ? 0x80 : 0x00;
+    for (int c = 0; c < 4; c++)
+        if (channels[c].enabled)
+            status |= 1 << c;
+    memory->poke(NR52, status);
+}
+
+/////////////////////////  Channels  ////////////////////////////////
+
+void APU::sync() {
+    if (mode != AudioMode::Off)
+        run(now());
+}
+
+void APU::run(uint64_t cycle) {
+    const bool output = mode == AudioMode::Full;
+    while (nextTick <= cycle) {
+        if (output)
+            for (int c = 0; c < 4; c++)
+                runChannel(c, nextTick);
+        synced = nextTick;
+        clockSequencer();
+        if (output)
+            endFrame(nextTick);
+        nextTick += SEQUENCER_PERIOD;
+    }
+    if (output)
+        for (int c = 0; c < 4; c++)
+            runChannel(c, cycle);
+    synced = std::max(synced, cycle);
+}
+
+// Step the waveform through every edge up to `cycle`. The period only
+// changes on register writes and sweep steps, which sync before they happen.
+void APU::runChannel(int c, uint64_t cycle) {
+    ApuChannel& ch = channels[c];
+    if (!ch.enabled || ch.nextEdge > cycle)
+        return;
+    const uint32_t step = period(c);
+    const uint64_t edges = (cycle - ch.nextEdge) / step + 1;
+
+    // A channel at volume 0 stays silent whatever its position, so the edges
+    // are skipped arithmetically (the noise sequence's phase is not audible)
+    bool silent = c == 2 ? !(reg(NR32) & 0x60) : ch.volume == 0;
+    if (silent) {
+        if (c != 3)
+            ch.position = static_cast<uint8_t>((ch.position + edges) & (c == 2 ? 31 : 7));
+        ch.nextEdge += edges * step;
+        return;
+    }
+
+    for (; ch.nextEdge <= cycle; ch.nextEdge += step) {
+        if (c == 3) {
+            uint16_t bit = (ch.lfsr ^ (ch.lfsr >> 1)) & 1;
+            ch.lfsr = static_cast<uint16_t>((ch.lfsr >> 1) | (bit << 14));
+            if (reg(NR43) & 0x08)
+                ch.lfsr = static_cast<uint16_t>((ch.lfsr & ~0x40) | (bit << 6));
+        } else {
+            ch.position = (ch.position + 1) & (c == 2 ? 31 : 7);
+        }
+        setLevel(c, channelOutput(c), ch.nextEdge);
+    }
+}
+
+uint32_t APU::period(int c) const {
+    const ApuChannel& ch = channels[c];
+    switch (c) {
+        case 0:
+        case 1:
+            return (2048u - ch.frequency) * 4;
+        case 2:
+            return (2048u - ch.frequency) * 2;
+        default: {
+            uint8_t nr43 = reg(NR43);
+            unsigned shift = nr43 >> 4;
+            if (shift >= 14)
+                return STOPPED_PERIOD;
+            unsigned divisor = nr43 & 7;
+            return (divisor ? divisor * 16 : 8) << shift;
+        }
+    }
+}
+
+uint8_t APU::channelOutput(int c) const {
+    const ApuChannel& ch = channels[c];
+    if (!ch.enabled)
+        return 0;
+    switch (c) {
+        case 0:
+        case 1:
+            return (DUTY[reg(NRX1[c]) >> 6] >> ch.position) & 1 ? ch.volume : 0;
+        case 2: {
+            uint8_t pair = reg(WAVE_RAM + ch.position / 2);
+            uint8_t sample = ch.position & 1 ? pair & 0x0F : pair >> 4;
+            return sample >> WAVE_SHIFT[(reg(NR32) >> 5) & 3];
+        }
+        default:
+            return ch.lfsr & 1 ? 0 : ch.volume;
+    }
+}
+
+/////////////////////////  Frame sequencer  ////////////////////////////////
+
+// One 512 Hz step at cycle `synced`: lengths at 256 Hz, sweep at 128 Hz,
+// envelopes at 64 Hz
+void APU::clockSequencer() {
+    if (!powered)
+        return;
+    if (!(sequencerStep & 1))
+        clockLengths();
+    if (sequencerStep == 2 || sequencerStep == 6)
+        clockSweep();
+    // Envelope volume is not readable, so silent mode leaves it alone
+    if (sequencerStep == 7 && mode == AudioMode::Full)
+        clockEnvelopes();
+    sequencerStep = (sequencerStep + 1) & 7;
+}
+
+void APU::clockLengths() {
+    for (int c = 0; c < 4; c++) {
+        ApuChannel& ch = channels[c];
+        if (!(reg(NRX1[c] + 3) & 0x40) || ch.length == 0)
+            continue;
+        if (--ch.length == 0 && ch.enabled)
+            disable(c, synced);
+    }
+}
+
+uint16_t APU::sweepTarget() const {
+    uint8_t sweep = reg(NR10);
+    uint16_t delta = sweepShadow >> (sweep & 7);
+    return sweep & 0x08 ? sweepShadow - delta : sweepShadow + delta;
+}
+
+void APU::clockSweep() {
+    if (sweepTimer > 1) {
+        sweepTimer--;
+        return;
+    }
+    uint8_t sweep = reg(NR10);
+    uint8_t sweepPeriod = (sweep >> 4) & 7;
+    sweepTimer = sweepPeriod ? sweepPeriod : 8;
+    if (!sweepEnabled || !sweepPeriod || !channels[0].enabled)
+        return;
+
+    uint16_t target = sweepTarget();
+    if (target <= 0x7FF && (sweep & 7)) {
+        sweepShadow = target;
+        channels[0].frequency = target;
+        memory->poke(NR13, static_cast<uint8_t>(target));
+        memory->poke(NR14, static_cast<uint8_t>((reg(NR14) & 0xF8) | (target >> 8)));
+        target = sweepTarget();  // The next value is checked for overflow too
+    }
+    if (target > 0x7FF)
+        disable(0, synced);
+}
+
+void APU::clockEnvelopes() {
+    for (int c : {0, 1, 3}) {
+        ApuChannel& ch = channels[c];
+        uint8_t envelope = reg(NRX1[c] + 1);
+        uint8_t envelopePeriod = envelope & 7;
+        if (!ch.enabled || !envelopePeriod)
+            continue;
+        if (ch.envelopeTimer > 1) {
+            ch.envelopeTimer--;
+            continue;
+        }
+        ch.envelopeTimer = envelopePeriod;
+        if ((envelope & 0x08) && ch.volume < 15)
+            ch.volume++;
+        else if (!(envelope & 0x08) && ch.volume > 0)
+            ch.volume--;
+        else
+            continue;
+        setLevel(c, channelOutput(c), synced);
+    }
+}
+
+/////////////////////////  Output  ////////////////////////////////
+
+void APU::setLevel(int c, uint8_t level, uint64_t cycle) {
+    if (mode != AudioMode::Full)
+        return;
+    int diff = level - levels[c];
+    if (!diff)
+        return;
+    levels[c] = level;
+    uint32_t time = static_cast<uint32_t>(cycle - frameStart);
+    if (gainLeft[c] != 0.0f)
+        left.addDelta(time, diff * gainLeft[c]);
+    if (gainRight[c] != 0.0f)
+        right.addDelta(time, diff * gainRight[c]);
+}
+
+// NR50 master volume and NR51 panning; channels already sounding step to
+// their new loudness (levels only change in Full mode)
+void APU::updateGains(uint64_t cycle) {
+    uint8_t volume = reg(NR50);
+    uint8_t panning = reg(NR51);
+    float volumeLeft = (((volume >> 4) & 7) + 1) * OUTPUT_SCALE;
+    float volumeRight = ((volume & 7) + 1) * OUTPUT_SCALE;
+    uint32_t time = static_cast<uint32_t>(cycle - frameStart);
+    const bool output = mode == AudioMode::Full;
+    for (int c = 0; c < 4; c++) {
+        float newLeft = (panning >> (4 + c)) & 1 ? volumeLeft : 0.0f;
+        float newRight = (panning >> c) & 1 ? volumeRight : 0.0f;
+        if (output && levels[c] && newLeft != gainLeft[c])
+            left.addDelta(time, levels[c] * (newLeft - gainLeft[c]));
+        if (output && levels[c] && newRight != gainRight[c])
+            right.addDelta(time, levels[c] * (newRight - gainRight[c]));
+        gainLeft[c] = newLeft;
+        gainRight[c] = newRight;
+    }
+}
+
+// Start a new output frame at `cycle` from silence, stepping to the current levels
+void APU::restartOutput(uint64_t cycle) {
+    frameStart = cycle;
+    left.clear();
+    right.clear();
+    std::fill(levels, levels + 4, 0);
+    updateGains(cycle);
+    for (int c = 0; c < 4; c++)
+        setLevel(c, channelOutput(c), cycle);
+}
+
+void APU::endFrame(uint64_t cycle) {
+    uint32_t clocks = static_cast<uint32_t>(cycle - frameStart);
+    left.endFrame(clocks);
+    right.endFrame(clocks);
+    frameStart = cycle;
+
+    size_t count = static_cast<size_t>(left.samplesAvailable());
+    size_t base = samples.size();
+    samples.resize(base + 2 * count);
+    left.read(samples.data() + base, static_cast<int>(count), 2);
+    right.read(samples.data() + base + 1, static_cast<int>(count), 2);
+
+    // Nobody is reading: drop all but the most recent quarter second once
+    // half a second has piled up (trimming every frame would move the whole
+    // backlog each time)
+    size_t limit = 2 * static_cast<size_t>(sampleRate / 4);
+    if (samples.size() > 2 * limit)
+        samples.erase(samples.begin(), samples.begin() + (samples.size() - limit));
+}
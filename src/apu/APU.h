@@ -0,0 +1,145 @@
+#ifndef APU_H
+#define APU_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "BlipBuffer.h"
+#include "cpu/CPU.h"
+#include "memory/Memory.h"
+
+// How much of the APU runs
+enum class AudioMode : uint8_t {
+    Off,     // Sound registers are plain memory and the APU does no work
+    Silent,  // Exact register behaviour (NR52 status, lengths, sweep), no output
+    Full     // Register behaviour and synthesized output
+};
+
+// One sound channel (pulse 1-2, wave 3, noise 4)
+struct ApuChannel {
+    bool enabled;          // NR52 status bit
+    bool dacOn;
+    uint16_t length;       // Length counter clocks left
+    uint16_t frequency;    // 11-bit period value (pulse and wave)
+    uint8_t volume;        // Envelope volume (pulse and noise)
+    uint8_t envelopeTimer;
+    uint8_t position;      // Duty step (pulse) or sample index (wave)
+    uint16_t lfsr;         // Noise shift register
+    uint64_t nextEdge;     // Cycle of the next waveform step
+};
+
+// APU state outside memory (save states)
+struct APUState {
+    ApuChannel channels[4];
+    uint16_t sweepShadow;
+    uint8_t sweepTimer;
+    bool sweepEnabled;
+    bool powered;
+    uint8_t sequencerStep;
+    uint64_t synced;
+    uint64_t nextTick;
+};
+
+// Sound unit (0xFF10-0xFF3F). Registers live in Memory behind I/O handlers.
+// The APU runs lazily: each channel steps from one waveform edge to the next
+// when it is brought up to date (a register access or a frame sequencer
+// tick), and an edge only costs work when the channel's output level
+// changes, as one band-limited step in a BlipBuffer per side. Cost follows
+// register activity and audible edges instead of clock cycles.
+class APU {
+public:
+    static constexpr double CLOCK_RATE = 4194304.0;
+    static constexpr uint32_t SEQUENCER_PERIOD = 8192;  // Cycles per frame sequencer step (512 Hz)
+
+    APU(Memory* mem, const CPU* cpu);
+
+    // Install (Silent, Full) or remove (Off) the register handlers
+    void setMode(AudioMode mode);
+    AudioMode getMode() const { return mode; }
+
+    // Power-on register state
+    void reset();
+
+    // Output rate of readSamples()
+    bool setSampleRate(uint32_t rate);
+    uint32_t getSampleRate() const { return sampleRate; }
+
+    // Run the channels up to the current cycle
+    void sync();
+
+    // Cycle a scheduler should call sync() at (UINT64_MAX for none). Full
+    // output needs every frame sequencer step; silent mode only the steps
+    // that end a channel, the others are caught up on register access.
+    uint64_t nextEventTime() const;
+
+    // Called with nextEventTime() whenever a register write may have moved
+    // it, so the owner can reschedule its event
+    using EventHook = void (*)(void* context, uint64_t when);
+    void setEventHook(EventHook hook, void* context);
+
+    // Interleaved left/right 16-bit samples produced so far. If nobody
+    // reads, older samples are dropped, keeping at least a quarter second.
+    size_t samplesAvailable() const { return samples.size() / 2; }
+    size_t readSamples(int16_t* out, size_t frames);
+
+    APUState saveState() const;
+    void loadState(const APUState& state);
+
+private:
+    static uint8_t readRegister(void* context, uint16_t address);
+    static void writeRegister(void* context, uint16_t address, uint8_t value);
+
+    uint64_t now() const { return cpu->getCycles(); }
+    uint8_t reg(uint16_t address) const { return memory->raw()[address]; }
+
+    void write(uint16_t address, uint8_t value);
+    void trigger(int c);
+    void setPower(bool on);
+    void disable(int c, uint64_t cycle);
+    void updateStatus();
+
+    // Advance channel waveforms to `cycle` and clock the frame sequencer on the way
+    void run(uint64_t cycle);
+    void runChannel(int c, uint64_t cycle);
+    void clockSequencer();
+    void clockLengths();
+    void clockSweep();
+    void clockEnvelopes();
+    uint16_t sweepTarget() const;
+
+    uint32_t period(int c) const;
+    uint8_t channelOutput(int c) const;
+
+    // Output level changes, turned into band-limited steps
+    void setLevel(int c, uint8_t level, uint64_t cycle);
+    void updateGains(uint64_t cycle);
+    void endFrame(uint64_t cycle);
+    void restartOutput(uint64_t cycle);
+
+    Memory* memory;
+    const CPU* cpu;
+    AudioMode mode = AudioMode::Off;
+    EventHook eventHook = nullptr;
+    void* eventContext = nullptr;
+
+    ApuChannel channels[4] = {};
+    uint16_t sweepShadow = 0;
+    uint8_t sweepTimer = 0;
+    bool sweepEnabled = false;
+    bool powered = true;
+    uint8_t sequencerStep = 0;
+    uint64_t synced = 0;      // Cycle the channels have been run to
+    uint64_t nextTick = SEQUENCER_PERIOD;
+
+    // Output (client settings and derived values, not saved state)
+    uint32_t sampleRate = 48000;
+    BlipBuffer left;
+    BlipBuffer right;
+    uint64_t frameStart = 0;  // Cycle the current BlipBuffer frame started at
+    uint8_t levels[4] = {};   // Level last emitted per channel
+    float gainLeft[4] = {};   // Step size per level unit, from NR50/NR51
+    float gainRight[4] = {};
+    std::vector<int16_t> samples;
+};
+
+#endif // APU_H
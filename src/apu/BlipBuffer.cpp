@@ -0,0 +1,134 @@
+#include "BlipBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Part of the running sum kept per sample. The leak is a high-pass around
+// 15 Hz at 48 kHz that removes the DC offset of the unipolar channel outputs.
+static constexpr float LEAK_KEEP = 1.0f - 1.0f / 512.0f;
+
+// Band-limited impulses for each sub-sample phase: a Blackman-windowed sinc
+// cut off below the output Nyquist rate, normalized so each sums to 1 (a
+// step of 1 integrates to exactly 1)
+struct ImpulseTable {
+    alignas(32) float taps[BlipBuffer::PHASES][BlipBuffer::TAPS];
+
+    ImpulseTable() {
+        constexpr double PI = 3.14159265358979323846;
+        constexpr double CUTOFF = 0.9;  // Fraction of the output Nyquist rate
+        constexpr int TAPS = BlipBuffer::TAPS;
+        for (int p = 0; p < BlipBuffer::PHASES; p++) {
+            double sum = 0.0;
+            double values[TAPS];
+            for (int k = 0; k < TAPS; k++) {
+                // Distance from the step, which sits between taps TAPS/2 - 1 and TAPS/2
+                double x = k - (TAPS / 2 - 1) - static_cast<double>(p) / BlipBuffer::PHASES;
+                double sinc = x == 0.0 ? 1.0 : std::sin(PI * CUTOFF * x) / (PI * CUTOFF * x);
+                double w = 2.0 * PI * (x / TAPS + 0.5);
+                double window = 0.42 - 0.5 * std::cos(w) + 0.08 * std::cos(2.0 * w);
+                values[k] = sinc * window;
+                sum += values[k];
+            }
+            for (int k = 0; k < TAPS; k++)
+                taps[p][k] = static_cast<float>(values[k] / sum);
+        }
+    }
+};
+
+static const ImpulseTable IMPULSES;
+
+bool BlipBuffer::setRates(double clockRate, uint32_t sampleRate, uint32_t maxFrameClocks) {
+    if (clockRate <= 0.0 || sampleRate == 0 || sampleRate >= clockRate) {
+        std::cerr << "BlipBuffer::setRates failed: need 0 < sample rate < clock rate" << std::endl;
+        return false;
+    }
+    factor = static_cast<uint64_t>(std::ldexp(sampleRate / clockRate, 32));
+    size_t frameSamples = static_cast<size_t>((maxFrameClocks * factor) >> 32) + 1;
+    buffer.assign(frameSamples + TAPS, 0.0f);
+    clear();
+    return true;
+}
+
+void BlipBuffer::clear() {
+    std::fill(buffer.begin(), buffer.end(), 0.0f);
+    offset = 0;
+    available = 0;
+    integrator = 0.0f;
+}
+
+void BlipBuffer::addDelta(uint32_t time, float delta) {
+    uint64_t position = offset + time * factor;
+    float* out = buffer.data() + (position >> 32);
+    const float* impulse = IMPULSES.taps[(position >> (32 - PHASE_BITS)) & (PHASES - 1)];
+#if defined(__AVX__)
+    const __m256 scale = _mm256_set1_ps(delta);
+    for (int k = 0; k < TAPS; k += 8) {
+        __m256 sum = _mm256_add_ps(_mm256_loadu_ps(out + k), _mm256_mul_ps(scale, _mm256_load_ps(impulse + k)));
+        _mm256_storeu_ps(out + k, sum);
+    }
+#elif defined(__SSE2__)
+    const __m128 scale = _mm_set1_ps(delta);
+    for (int k = 0; k < TAPS; k += 4) {
+        __m128 sum = _mm_add_ps(_mm_loadu_ps(out + k), _mm_mul_ps(scale, _mm_load_ps(impulse + k)));
+        _mm_storeu_ps(out + k, sum);
+    }
+#else
+    for (int k = 0; k < TAPS; k++)
+        out[k] += delta * impulse[k];
+#endif
+}
+
+void BlipBuffer::endFrame(uint32_t clocks) {
+    offset += clocks * factor;
+    available = static_cast<int>(offset >> 32);
+}
+
+int BlipBuffer::read(int16_t* out, int count, int stride) {
+    // Output i = buffer[i] + LEAK_KEEP * output i-1: a running sum that leaks
+    // toward zero
+    count = std::min(count, available);
+    const float* in = buffer.data();
+    float sum = integrator;
+    int i = 0;
+#if defined(__SSE2__)
+    // Four outputs at a time: a log-step scan inside the vector, then the
+    // previous output scaled by LEAK_KEEP^1..4. Packing to 16 bits saturates.
+    const float k1 = LEAK_KEEP, k2 = k1 * k1;
+    const __m128 keep1 = _mm_set1_ps(k1);
+    const __m128 keep2 = _mm_set1_ps(k2);
+    const __m128 keepCarry = _mm_setr_ps(k1, k2, k2 * k1, k2 * k2);
+    __m128 carry = _mm_set1_ps(sum);
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_loadu_ps(in + i);
+        v = _mm_add_ps(v, _mm_mul_ps(keep1, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4))));
+        v = _mm_add_ps(v, _mm_mul_ps(keep2, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8))));
+        v = _mm_add_ps(v, _mm_mul_ps(keepCarry, carry));
+        carry = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(v), _mm_setzero_si128());
+        out[(i + 0) * stride] = static_cast<int16_t>(_mm_extract_epi16(packed, 0));
+        out[(i + 1) * stride] = static_cast<int16_t>(_mm_extract_epi16(packed, 1));
+        out[(i + 2) * stride] = static_cast<int16_t>(_mm_extract_epi16(packed, 2));
+        out[(i + 3) * stride] = static_cast<int16_t>(_mm_extract_epi16(packed, 3));
+    }
+    sum = _mm_cvtss_f32(carry);
+#endif
+    for (; i < count; i++) {
+        sum = sum * LEAK_KEEP + in[i];
+        float sample = std::min(32767.0f, std::max(-32768.0f, sum));
+        out[i * stride] = static_cast<int16_t>(std::lrint(sample));
+    }
+    integrator = sum;
+
+    // Keep the impulse tails that reach past the samples read
+    size_t pending = static_cast<size_t>(available - count) + TAPS;
+    memmove(buffer.data(), buffer.data() + count, pending * sizeof(float));
+    std::fill(buffer.begin() + pending, buffer.begin() + pending + count, 0.0f);
+    available -= count;
+    offset -= static_cast<uint64_t>(count) << 32;
+    return count;
+}
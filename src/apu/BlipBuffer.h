@@ -0,0 +1,48 @@
+#ifndef BLIPBUFFER_H
+#define BLIPBUFFER_H
+
+#include <cstdint>
+#include <vector>
+
+// Band-limited synthesis of a square-ish signal at the host sample rate.
+//
+// The input is a list of amplitude steps stamped in emulated clock cycles.
+// Each step adds a windowed-sinc impulse (one of PHASES sub-sample offsets)
+// into a buffer at the output rate, and reading integrates the buffer back
+// into a waveform. Clock-rate signals are resampled without aliasing, and the
+// work is proportional to the number of steps rather than to clock cycles.
+//
+// Time runs in frames: steps are stamped relative to the start of the current
+// frame, and endFrame() makes the samples before the frame's end readable.
+// The buffer holds one frame, so the samples must be read before the next
+// frame ends.
+class BlipBuffer {
+public:
+    static constexpr int TAPS = 16;        // Impulse length in output samples
+    static constexpr int PHASE_BITS = 5;
+    static constexpr int PHASES = 1 << PHASE_BITS;
+
+    // `maxFrameClocks` bounds the length of one frame
+    bool setRates(double clockRate, uint32_t sampleRate, uint32_t maxFrameClocks);
+    void clear();
+
+    // Add an amplitude change of `delta` at `time` clocks into the frame
+    void addDelta(uint32_t time, float delta);
+
+    // End the frame `clocks` after its start; the next frame starts there
+    void endFrame(uint32_t clocks);
+
+    int samplesAvailable() const { return available; }
+
+    // Remove up to `count` samples into out[0], out[stride], ...
+    int read(int16_t* out, int count, int stride);
+
+private:
+    std::vector<float> buffer;  // Impulses; output sample i is the running sum up to i
+    uint64_t factor = 0;        // Output samples per clock, 32.32 fixed point
+    uint64_t offset = 0;        // Frame start in output samples, 32.32
+    int available = 0;
+    float integrator = 0.0f;    // Last output sample
+};
+
+#endif // BLIPBUFFER_H
@@ -1,185 +1,263 @@
-#ifndef CPU_H
-#define CPU_H
-
-#include <cstdint>
-#include "CPURegisters.h"
-#include "memory/Memory.h"
-
-// 16-bit Register pairs
-enum class Reg16 {
-    BC,
-    DE,
-    HL,
-    SP,
-    AF   // Added AF for stack operations PUSH/POP
-};
-
-// 8-bit Registers
-enum class Reg8 {
-    A,
-    B,
-    C,
-    D,
-    E,
-    H,
-    L
-};
-
-// Conditional flags for conditional jumps and calls
-enum class Condition {
-    NZ, // Non-zero (Z reset)
-    Z,  // Zero (Z set)
-    NC, // No carry (C reset)
-    C   // Carry (C set)
-};
-
-class CPU {
-public:
-    CPU(Memory* mem, CPURegisters* regs);
-
-    // Run one instruction step (fetch, decode, execute)
-    void step();
-
-    // Run N instructions
-    void run(int steps);
-
-    // Reset CPU
-    void reset();
-
-private:
-    CPURegisters* registers;
-    Memory* memory;
-
-    uint8_t fetch();
-    void decodeRun(uint8_t opcode);
-
-    bool halted = false;
-    bool ime = false;
-    bool imePending = false;
-    int cycles = 0;
-
-    // 16-bit load
-    void LD_rr_d16(Reg16 reg);
-    void LD_a16_SP();
-    void LD_HL_SP_r8();
-    void LD_SP_HL();
-
-    // 8-bit load
-    void LD_pRR_r(Reg16 rr, Reg8 r);
-    void LD_r_pRR(Reg8 r, Reg16 rr);
-    void LD_r_r(Reg8 dst, Reg8 src);
-    void LD_r_d8(Reg8 r);
-    void LDH_pa8_a();
-    void LDH_a_pa8();
-    void LD_A_pC();
-    void LD_pC_A();
-    void LD_pa16_A();
-    void LD_A_pa16();
-    void LD_A_pHL_inc();
-    void LD_A_pHL_dec();
-    void LD_pHL_inc_A();
-    void LD_pHL_dec_A();
-    void LD_pHL_d8();
-
-    // Miscellaneous
-    void NOP();
-    void DI();
-    void EI();
-    void PrefixCB();
-    void STOP();
-    void HALT();
-
-    // Stack
-    void POP_rr(Reg16 rr);
-    void PUSH_rr(Reg16 rr);
-
-    // JR Jumps
-    void JR_Nr_r8(Condition cond);
-    void JR_r8();
-
-    // JP Jumps
-    void JP_Nr_pa16(Condition cond);
-    void JP_HL();
-    void JP_a16();
-
-    // CALL
-    void CALL_Nr_a16(Condition cond);
-    void CALL_a16();
-
-    // RET
-    void RET_Nr(Condition cond);
-    void RET();
-    void RETI();
-
-    // 16-bit Arithmetic
-    void ADD_HL_rr(Reg16 reg);
-    void ADD_SP_r8();
-    void INC_rr(Reg16 reg);
-    void DEC_rr(Reg16 reg);
-
-    // 8-bit Arithmetic
-    void ADD_r(Reg8 dst);
-    void ADD_pHL();
-    void ADD_r8();
-    void SUB_r(Reg8 src);
-    void SUB_pHL();
-    void SUB_r8();
-    void ADC_r(Reg8 r);
-    void ADC_pHL();
-    void ADC_r8();
-    void SBC_r(Reg8 r);
-    void SBC_pHL();
-    void INC_r(Reg8 r);
-    void INC_pHL();
-    void DEC_r(Reg8 r);
-    void DEC_pHL();
-
-    // Logical instructions
-    void AND_r(Reg8 r);
-    void AND_pHL();
-    void OR_r(Reg8 r);
-    void OR_pHL();
-    void XOR_r(Reg8 r);
-    void XOR_pHL();
-    void CP_r(Reg8 r);
-    void CP_pHL();
-    void CP_d8();
-
-    // Rotate/Shift (CB prefix)
-    void RLC_r();
-    void RRC_r();
-    void RL_r();
-    void RR_r();
-    void SLA_r();
-    void SRA_r();
-    void SRL_r();
-    void SWAP_r();
-    void BIT_n_r();
-    void RES_n_r();
-    void SET_n_r();
-
-    // Misc operations
-    void DAA();
-    void CPL();
-    void CCF();
-    void SCF();
-
-    // Extra rotate operations (non-CB)
-    void RLCA();
-    void RLA();
-    void RRCA();
-    void RRA();
-
-    // Immediate variants of arithmetic instructions
-    void AND_d8();
-    void OR_d8();
-    void XOR_d8();
-    void SUB_d8();
-    void ADC_d8();
-    void SBC_d8();
-
-    // Restart instruction
-    void RST(uint8_t addr);
-};
-
+#ifndef CPU_H
+#define CPU_H
+
+#include <cstdint>
+#include "CPURegisters.h"
+#include "ProfilePolicy.h"
+#include "TracePolicy.h"
+#include "memory/Memory.h"
+
+// 16-bit Register pairs
+enum class Reg16 {
+    BC,
+    DE,
+    HL,
+    SP,
+    AF   // Added AF for stack operations PUSH/POP
+};
+
+// 8-bit Registers
+enum class Reg8 {
+    A,
+    B,
+    C,
+    D,
+    E,
+    H,
+    L
+};
+
+// Conditional flags for conditional jumps and calls
+enum class Condition {
+    NZ, // Non-zero (Z reset)
+    Z,  // Zero (Z set)
+    NC, // No carry (C reset)
+    C   // Carry (C set)
+};
+
+// Interrupt request bits in IF (0xFF0F) and IE (0xFFFF), highest priority first
+enum Interrupt : uint8_t {
+    INT_VBLANK = 0x01,
+    INT_STAT = 0x02,
+    INT_TIMER = 0x04,
+    INT_SERIAL = 0x08,
+    INT_JOYPAD = 0x10
+};
+
+// CPU state outside the register file (save states, trace replay)
+struct CPUState {
+    uint64_t cycles;
+    bool halted;
+    bool ime;
+    bool imePending;
+    uint8_t imeDelay;   // Instruction boundaries until a pending EI sets IME
+};
+
+class CPU {
+public:
+    CPU(Memory* mem, CPURegisters* regs);
+
+    // Run one instruction step (fetch, decode, execute)
+    void step();
+
+    // Run N instructions
+    void run(int steps);
+
+    // Run instructions until the cycle counter reaches `deadline`. A halted
+    // CPU idles: its counter moves straight to the deadline.
+    void runUntil(uint64_t deadline);
+
+    // Reset CPU
+    void reset();
+
+    // Cycles elapsed so far
+    uint64_t getCycles() const { return cycles; }
+
+    bool isHalted() const { return halted; }
+
+    // Halted with nothing able to wake it before the next external event
+    bool isIdle() const { return halted && !attention; }
+
+    // Route IF/IE writes in memory through the CPU so it can keep its
+    // interrupt attention word current (not done for trace replay, which
+    // reproduces recorded state instead)
+    void attachInterrupts();
+
+    // Recompute the attention word after IF/IE changed behind the handlers
+    // (memory snapshot loads)
+    void refreshInterrupts();
+
+    // Take interrupt `bit` (0-4): clear its IF bit and IME, push PC and jump
+    // to the vector. Normally done by step(); trace replay calls it for
+    // recorded dispatches.
+    void dispatchInterrupt(uint8_t bit);
+
+    CPUState saveState() const;
+    void loadState(const CPUState& state);
+
+    // Instruction trace (BufferTrace when built with GB_TRACE, otherwise NullTrace)
+    TracePolicy& tracer() { return trace; }
+
+    // Opcode/PC profile (OpcodeProfile when built with GB_PROFILE, otherwise NullProfile)
+    ProfilePolicy& profiler() { return profile; }
+
+private:
+    CPURegisters* registers;
+    Memory* memory;
+
+    uint8_t fetch();
+    void decodeRun(uint8_t opcode);
+
+    // Data memory access used by instruction handlers (reports to the trace policy)
+    uint8_t readMem(uint16_t address);
+    void writeMem(uint16_t address, uint8_t value);
+
+    bool halted = false;
+    bool ime = false;
+    bool imePending = false;
+    uint8_t imeDelay = 0;
+    uint64_t cycles = 0;
+
+    // Checked once per instruction; non-zero only when something needs the
+    // slow path: requested & enabled interrupts that IME or HALT make
+    // relevant (bits 0-4) or a pending EI (bit 7). Updated only when IF, IE,
+    // IME or the halted state change.
+    uint8_t attention = 0;
+    uint8_t requested = 0;   // IE & IF & 0x1F
+
+    static constexpr uint8_t ATTENTION_EI = 0x80;
+
+    void updateAttention() {
+        attention = static_cast<uint8_t>(((ime || halted) ? requested : 0) | (imeDelay ? ATTENTION_EI : 0));
+    }
+    void serviceInterrupts();
+    static void writeInterruptRegister(void* context, uint16_t address, uint8_t value);
+
+    TracePolicy trace;
+    ProfilePolicy profile;
+
+    // 16-bit load
+    void LD_rr_d16(Reg16 reg);
+    void LD_a16_SP();
+    void LD_HL_SP_r8();
+    void LD_SP_HL();
+
+    // 8-bit load
+    void LD_pRR_r(Reg16 rr, Reg8 r);
+    void LD_r_pRR(Reg8 r, Reg16 rr);
+    void LD_r_r(Reg8 dst, Reg8 src);
+    void LD_r_d8(Reg8 r);
+    void LDH_pa8_a();
+    void LDH_a_pa8();
+    void LD_A_pC();
+    void LD_pC_A();
+    void LD_pa16_A();
+    void LD_A_pa16();
+    void LD_A_pHL_inc();
+    void LD_A_pHL_dec();
+    void LD_pHL_inc_A();
+    void LD_pHL_dec_A();
+    void LD_pHL_d8();
+
+    // Miscellaneous
+    void NOP();
+    void DI();
+    void EI();
+    void PrefixCB();
+    void STOP();
+    void HALT();
+
+    // Stack
+    void POP_rr(Reg16 rr);
+    void PUSH_rr(Reg16 rr);
+
+    // JR Jumps
+    void JR_Nr_r8(Condition cond);
+    void JR_r8();
+
+    // JP Jumps
+    void JP_Nr_pa16(Condition cond);
+    void JP_HL();
+    void JP_a16();
+
+    // CALL
+    void CALL_Nr_a16(Condition cond);
+    void CALL_a16();
+
+    // RET
+    void RET_Nr(Condition cond);
+    void RET();
+    void RETI();
+
+    // 16-bit Arithmetic
+    void ADD_HL_rr(Reg16 reg);
+    void ADD_SP_r8();
+    void INC_rr(Reg16 reg);
+    void DEC_rr(Reg16 reg);
+
+    // 8-bit Arithmetic
+    void ADD_r(Reg8 dst);
+    void ADD_pHL();
+    void ADD_r8();
+    void SUB_r(Reg8 src);
+    void SUB_pHL();
+    void SUB_r8();
+    void ADC_r(Reg8 r);
+    void ADC_pHL();
+    void ADC_r8();
+    void SBC_r(Reg8 r);
+    void SBC_pHL();
+    void INC_r(Reg8 r);
+    void INC_pHL();
+    void DEC_r(Reg8 r);
+    void DEC_pHL();
+
+    // Logical instructions
+    void AND_r(Reg8 r);
+    void AND_pHL();
+    void OR_r(Reg8 r);
+    void OR_pHL();
+    void XOR_r(Reg8 r);
+    void XOR_pHL();
+    void CP_r(Reg8 r);
+    void CP_pHL();
+    void CP_d8();
+
+    // Rotate/Shift (CB prefix)
+    void RLC_r();
+    void RRC_r();
+    void RL_r();
+    void RR_r();
+    void SLA_r();
+    void SRA_r();
+    void SRL_r();
+    void SWAP_r();
+    void BIT_n_r();
+    void RES_n_r();
+    void SET_n_r();
+
+    // Misc operations
+    void DAA();
+    void CPL();
+    void CCF();
+    void SCF();
+
+    // Extra rotate operations (non-CB)
+    void RLCA();
+    void RLA();
+    void RRCA();
+    void RRA();
+
+    // Immediate variants of arithmetic instructions
+    void AND_d8();
+    void OR_d8();
+    void XOR_d8();
+    void SUB_d8();
+    void ADC_d8();
+    void SBC_d8();
+
+    // Restart instruction
+    void RST(uint8_t addr);
+};
+
 #endif //CPU_H
\ No newline at end of file
@@ -0,0 +1,106 @@
+#ifndef PROFILEPOLICY_H
+#define PROFILEPOLICY_H
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+// Execution counters of one CPU. Each CPU only touches its own counters, so
+// there are no atomics; counters from several CPUs/threads are combined with
+// merge() when reporting.
+struct ProfileCounters {
+    uint64_t opcodeCount[256];
+    uint64_t opcodeCycles[256];   // Includes the CB opcode for 0xCB
+    uint64_t cbCount[256];
+    uint64_t cbCycles[256];
+
+    // Sampled opcode addresses, keyed by (ROM bank << 16) | PC
+    std::unordered_map<uint32_t, uint64_t> pcSamples;
+    uint64_t sampleCount;
+
+    ProfileCounters() { clear(); }
+
+    void clear() {
+        memset(opcodeCount, 0, sizeof(opcodeCount));
+        memset(opcodeCycles, 0, sizeof(opcodeCycles));
+        memset(cbCount, 0, sizeof(cbCount));
+        memset(cbCycles, 0, sizeof(cbCycles));
+        pcSamples.clear();
+        sampleCount = 0;
+    }
+
+    void merge(const ProfileCounters& other) {
+        for (int i = 0; i < 256; i++) {
+            opcodeCount[i] += other.opcodeCount[i];
+            opcodeCycles[i] += other.opcodeCycles[i];
+            cbCount[i] += other.cbCount[i];
+            cbCycles[i] += other.cbCycles[i];
+        }
+        for (const auto& entry : other.pcSamples)
+            pcSamples[entry.first] += entry.second;
+        sampleCount += other.sampleCount;
+    }
+};
+
+// Profile policies plug into CPU::step like the trace policies: the CPU
+// calls them behind `if constexpr (ProfilePolicy::enabled)`.
+
+// Policy used when profiling is compiled out
+struct NullProfile {
+    static constexpr bool enabled = false;
+
+    void retired(uint8_t, uint64_t) {}
+    void prefixed(uint8_t, uint64_t) {}
+    bool sampleDue(uint64_t) { return false; }
+    void sample(uint16_t, uint16_t) {}
+};
+
+// Counts executions and cycles per opcode and samples the PC every
+// `interval` cycles, so the PC histogram is weighted by time spent
+class OpcodeProfile {
+public:
+    static constexpr bool enabled = true;
+    static constexpr uint64_t DEFAULT_INTERVAL = 997;  // Prime, to avoid locking onto loop periods
+
+    void retired(uint8_t opcode, uint64_t cycles) {
+        counters.opcodeCount[opcode]++;
+        counters.opcodeCycles[opcode] += cycles;
+    }
+
+    void prefixed(uint8_t cbOpcode, uint64_t cycles) {
+        counters.cbCount[cbOpcode]++;
+        counters.cbCycles[cbOpcode] += cycles;
+    }
+
+    bool sampleDue(uint64_t cycle) {
+        if (cycle < nextSample)
+            return false;
+        nextSample = cycle + interval;
+        return true;
+    }
+
+    void sample(uint16_t bank, uint16_t pc) {
+        counters.pcSamples[(static_cast<uint32_t>(bank) << 16) | pc]++;
+        counters.sampleCount++;
+    }
+
+    void setInterval(uint64_t cycles) { interval = cycles ? cycles : 1; }
+    uint64_t getInterval() const { return interval; }
+
+    const ProfileCounters& getCounters() const { return counters; }
+    void clear() { counters.clear(); }
+
+private:
+    ProfileCounters counters;
+    uint64_t interval = DEFAULT_INTERVAL;
+    uint64_t nextSample = 0;
+};
+
+// Selected at configure time with -DGB_PROFILE=ON
+#if defined(GB_PROFILE) && GB_PROFILE
+using ProfilePolicy = OpcodeProfile;
+#else
+using ProfilePolicy = NullProfile;
+#endif
+
+#endif // PROFILEPOLICY_H
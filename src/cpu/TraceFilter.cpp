@@ -0,0 +1,237 @@
+#include "TraceFilter.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+uint32_t opcodeClass(uint8_t opcode) {
+    uint8_t low = opcode & 0x0F;
+
+    if (opcode < 0x40) {
+        switch (low) {
+            case 0x0:
+                return opcode < 0x20 ? OP_CONTROL : OP_JUMP;        // NOP, STOP / JR cc
+            case 0x8:
+                return opcode == 0x08 ? OP_LOAD16 : OP_JUMP;        // LD (a16),SP / JR
+            case 0x1:
+                return OP_LOAD16;                                   // LD rr,d16
+            case 0x2: case 0xA:
+            case 0x6: case 0xE:
+                return OP_LOAD8;                                    // LD (rr),A / LD r,d8
+            case 0x3: case 0xB:
+            case 0x9:
+                return OP_ARITH16;                                  // INC/DEC rr, ADD HL,rr
+            case 0x4: case 0x5:
+            case 0xC: case 0xD:
+                return OP_ARITH8;                                   // INC/DEC r
+            default:
+                return opcode < 0x20 ? OP_ROTATE : OP_FLAGS;        // RLCA.. / DAA CPL SCF CCF
+        }
+    }
+    if (opcode < 0x80)
+        return opcode == 0x76 ? OP_CONTROL : OP_LOAD8;              // HALT / LD r,r
+    if (opcode < 0xC0)
+        return opcode < 0xA0 ? OP_ARITH8 : OP_LOGIC;
+
+    switch (opcode) {
+        case 0xC0: case 0xC8: case 0xD0: case 0xD8:
+        case 0xC9: case 0xD9:
+            return OP_RET;
+        case 0xC1: case 0xD1: case 0xE1: case 0xF1:
+        case 0xC5: case 0xD5: case 0xE5: case 0xF5:
+            return OP_STACK;
+        case 0xC2: case 0xCA: case 0xD2: case 0xDA:
+        case 0xC3: case 0xE9:
+            return OP_JUMP;
+        case 0xC4: case 0xCC: case 0xD4: case 0xDC: case 0xCD:
+        case 0xC7: case 0xCF: case 0xD7: case 0xDF:
+        case 0xE7: case 0xEF: case 0xF7: case 0xFF:
+            return OP_CALL;
+        case 0xC6: case 0xCE: case 0xD6: case 0xDE:
+            return OP_ARITH8;
+        case 0xE6: case 0xEE: case 0xF6: case 0xFE:
+            return OP_LOGIC;
+        case 0xE0: case 0xF0: case 0xE2: case 0xF2:
+        case 0xEA: case 0xFA:
+            return OP_LOAD8;
+        case 0xE8:
+            return OP_ARITH16;
+        case 0xF8: case 0xF9:
+            return OP_LOAD16;
+        case 0xCB:
+            return 0;
+        default:
+            return OP_CONTROL;                                      // DI, EI, illegal
+    }
+}
+
+uint32_t cbOpcodeClass(uint8_t opcode) {
+    return opcode < 0x40 ? OP_ROTATE : OP_BIT;
+}
+
+/////////////////////////  Building  ////////////////////////////////
+
+TraceFilter::TraceFilter() {
+    memset(opcodeMap, 0, sizeof(opcodeMap));
+    memset(pcMap, 0, sizeof(pcMap));
+    memset(readMap, 0, sizeof(readMap));
+    memset(writeMap, 0, sizeof(writeMap));
+}
+
+void TraceFilter::setRange(uint64_t* map, unsigned first, unsigned last) {
+    for (unsigned bit = first; bit <= last; bit++)
+        map[bit >> 6] |= 1ULL << (bit & 63);
+}
+
+void TraceFilter::addPCRange(uint16_t first, uint16_t last) {
+    setRange(pcMap, first, last);
+    kinds |= PREDICATE_PC;
+}
+
+void TraceFilter::addOpcodeClasses(uint32_t classes) {
+    for (unsigned op = 0; op < 256; op++) {
+        if (opcodeClass(static_cast<uint8_t>(op)) & classes)
+            setRange(opcodeMap, op, op);
+        if (cbOpcodeClass(static_cast<uint8_t>(op)) & classes)
+            setRange(opcodeMap, 256 + op, 256 + op);
+    }
+    kinds |= PREDICATE_OPCODE;
+}
+
+void TraceFilter::addOpcode(uint16_t opcode) {
+    unsigned bit = opcode >= 0xCB00 ? 256 + (opcode & 0xFF) : (opcode & 0xFF);
+    setRange(opcodeMap, bit, bit);
+    kinds |= PREDICATE_OPCODE;
+}
+
+void TraceFilter::addReadWindow(uint16_t first, uint16_t last) {
+    setRange(readMap, first, last);
+    kinds |= PREDICATE_MEMORY;
+}
+
+void TraceFilter::addWriteWindow(uint16_t first, uint16_t last) {
+    setRange(writeMap, first, last);
+    kinds |= PREDICATE_MEMORY;
+}
+
+void TraceFilter::sampleEvery(uint32_t n) {
+    every = n ? n : 1;
+    counter = 0;
+}
+
+void TraceFilter::sampleRandom(double probability, uint64_t seed) {
+    if (probability >= 1.0)
+        threshold = RANDOM_ALL;
+    else
+        threshold = probability > 0.0 ? static_cast<uint64_t>(probability * RANDOM_ALL) : 0;
+    random = seed ? seed : 1;  // xorshift state must not be zero
+}
+
+/////////////////////////  Spec parsing  ////////////////////////////////
+
+static bool parseNumber(const std::string& text, unsigned long long& value, int base) {
+    if (text.empty())
+        return false;
+    char* end;
+    value = strtoull(text.c_str(), &end, base);
+    return *end == '\0';
+}
+
+// "0150-01FF" or a single address, hex with or without 0x
+static bool parseRange(const std::string& text, uint16_t& first, uint16_t& last) {
+    size_t dash = text.find('-');
+    unsigned long long a, b;
+    if (!parseNumber(text.substr(0, dash), a, 16))
+        return false;
+    b = a;
+    if (dash != std::string::npos && !parseNumber(text.substr(dash + 1), b, 16))
+        return false;
+    if (a > 0xFFFF || b > 0xFFFF || a > b)
+        return false;
+    first = static_cast<uint16_t>(a);
+    last = static_cast<uint16_t>(b);
+    return true;
+}
+
+static uint32_t classByName(const std::string& name) {
+    static const struct { const char* name; uint32_t classes; } names[] = {
+        {"load8", OP_LOAD8}, {"load16", OP_LOAD16}, {"load", OP_LOAD8 | OP_LOAD16},
+        {"arith8", OP_ARITH8}, {"arith16", OP_ARITH16}, {"logic", OP_LOGIC}, {"alu", OP_ALU},
+        {"rotate", OP_ROTATE}, {"bit", OP_BIT}, {"cb", OP_CB}, {"stack", OP_STACK},
+        {"jump", OP_JUMP}, {"call", OP_CALL}, {"ret", OP_RET}, {"branch", OP_BRANCH},
+        {"control", OP_CONTROL}, {"flags", OP_FLAGS},
+    };
+    for (const auto& entry : names)
+        if (name == entry.name)
+            return entry.classes;
+    return 0;
+}
+
+bool TraceFilter::compile(const std::string& spec) {
+    *this = TraceFilter();
+
+    double probability = 1.0;
+    unsigned long long seed = 1;
+    size_t pos = 0;
+    while (pos < spec.size()) {
+        size_t stop = spec.find_first_of(", ", pos);
+        if (stop == std::string::npos)
+            stop = spec.size();
+        std::string term = spec.substr(pos, stop - pos);
+        pos = stop + 1;
+        if (term.empty())
+            continue;
+
+        size_t eq = term.find('=');
+        std::string key = term.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : term.substr(eq + 1);
+        bool ok = true;
+
+        if (key == "pc" || key == "read" || key == "write" || key == "mem") {
+            uint16_t first, last;
+            ok = parseRange(value, first, last);
+            if (ok && key == "pc")
+                addPCRange(first, last);
+            if (ok && (key == "read" || key == "mem"))
+                addReadWindow(first, last);
+            if (ok && (key == "write" || key == "mem"))
+                addWriteWindow(first, last);
+        } else if (key == "op") {
+            size_t start = 0;
+            while (ok && start <= value.size()) {
+                size_t bar = value.find('|', start);
+                if (bar == std::string::npos)
+                    bar = value.size();
+                std::string name = value.substr(start, bar - start);
+                start = bar + 1;
+
+                unsigned long long opcode;
+                if (uint32_t classes = classByName(name))
+                    addOpcodeClasses(classes);
+                else if ((ok = parseNumber(name, opcode, 16) &&
+                               (opcode <= 0xFF || (opcode >= 0xCB00 && opcode <= 0xCBFF))))
+                    addOpcode(static_cast<uint16_t>(opcode));
+            }
+        } else if (key == "every") {
+            unsigned long long n;
+            ok = parseNumber(value, n, 10) && n > 0 && n <= 0xFFFFFFFF;
+            if (ok)
+                sampleEvery(static_cast<uint32_t>(n));
+        } else if (key == "random") {
+            char* end;
+            probability = strtod(value.c_str(), &end);
+            ok = !value.empty() && *end == '\0' && probability >= 0.0 && probability <= 1.0;
+        } else if (key == "seed") {
+            ok = parseNumber(value, seed, 10);
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << "TraceFilter::compile failed at '" << term << "'" << std::endl;
+            return false;
+        }
+    }
+
+    sampleRandom(probability, seed);
+    return true;
+}
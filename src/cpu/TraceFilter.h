@@ -0,0 +1,119 @@
+#ifndef TRACEFILTER_H
+#define TRACEFILTER_H
+
+#include <cstdint>
+#include <string>
+#include "TraceRecord.h"
+
+// Opcode classes, following instruction_Catagory.txt
+enum OpcodeClass : uint32_t {
+    OP_LOAD8    = 1 << 0,   // 8-bit loads, LDH
+    OP_LOAD16   = 1 << 1,   // 16-bit loads, LD (a16),SP, LD HL,SP+r8
+    OP_ARITH8   = 1 << 2,   // ADD/ADC/SUB/SBC, INC/DEC r
+    OP_ARITH16  = 1 << 3,   // ADD HL,rr, ADD SP,r8, INC/DEC rr
+    OP_LOGIC    = 1 << 4,   // AND/OR/XOR/CP
+    OP_ROTATE   = 1 << 5,   // RLCA.., CB rotates/shifts/SWAP
+    OP_BIT      = 1 << 6,   // CB BIT/RES/SET
+    OP_STACK    = 1 << 7,   // PUSH/POP
+    OP_JUMP     = 1 << 8,   // JR/JP
+    OP_CALL     = 1 << 9,   // CALL/RST
+    OP_RET      = 1 << 10,  // RET/RETI
+    OP_CONTROL  = 1 << 11,  // NOP, DI/EI, STOP, HALT, illegal opcodes
+    OP_FLAGS    = 1 << 12,  // DAA, CPL, SCF, CCF
+
+    OP_ALU = OP_ARITH8 | OP_ARITH16 | OP_LOGIC,
+    OP_BRANCH = OP_JUMP | OP_CALL | OP_RET,
+    OP_CB = OP_ROTATE | OP_BIT
+};
+
+// Class of an unprefixed opcode (0xCB itself is classified by the CB opcode)
+uint32_t opcodeClass(uint8_t opcode);
+uint32_t cbOpcodeClass(uint8_t opcode);
+
+// Record filter for trace capture. Predicates are compiled once into bitmaps
+// so the per-instruction check is a few bit tests:
+//   PC ranges        64K-bit map of opcode addresses
+//   opcodes          512-bit map (256 unprefixed + 256 CB opcodes)
+//   memory windows   64K-bit maps for reads and for writes; an instruction
+//                    matches when any of its accesses falls in a window
+// Predicate kinds that were not given accept everything; the kinds that were
+// given must all match. Sampling (every Nth, or random with a seed) is then
+// applied to the matching instructions.
+class TraceFilter {
+public:
+    TraceFilter();
+
+    // Compile a spec of comma or space separated terms:
+    //   pc=0150-01FF       opcode address range (hex, repeatable)
+    //   op=alu|0xCB7C|jump opcode classes or opcodes (0xCBnn = CB opcode)
+    //   read=FF00-FF7F     read window
+    //   write=FE00-FE9F    write window (e.g. OAM)
+    //   mem=C000-DFFF      read or write window
+    //   every=16           keep every 16th match
+    //   random=0.01        keep matches with probability 0.01
+    //   seed=1234          seed for random sampling
+    bool compile(const std::string& spec);
+
+    void addPCRange(uint16_t first, uint16_t last);
+    void addOpcodeClasses(uint32_t classes);
+    void addOpcode(uint16_t opcode);  // 0x00-0xFF, or 0xCB00-0xCBFF for CB opcodes
+    void addReadWindow(uint16_t first, uint16_t last);
+    void addWriteWindow(uint16_t first, uint16_t last);
+    void sampleEvery(uint32_t n);
+    void sampleRandom(double probability, uint64_t seed);
+
+    // Decide whether a completed record is kept
+    bool accept(const TraceRecord& r) {
+        if ((kinds & PREDICATE_PC) && !test(pcMap, r.pc))
+            return false;
+        if (kinds & PREDICATE_OPCODE) {
+            if (r.dispatch)
+                return false;  // No opcode to match
+            unsigned index = r.opcode == 0xCB && r.operandCount ? 256 + r.operands[0] : r.opcode;
+            if (!test(opcodeMap, index))
+                return false;
+        }
+        if (kinds & PREDICATE_MEMORY) {
+            bool hit = false;
+            for (int i = 0; i < r.memCount; i++)
+                hit |= test(r.mem[i].write ? writeMap : readMap, r.mem[i].address);
+            if (!hit)
+                return false;
+        }
+        if (every > 1 && ++counter < every)
+            return false;
+        counter = 0;
+        if (threshold < RANDOM_ALL) {
+            // xorshift64*
+            random ^= random >> 12;
+            random ^= random << 25;
+            random ^= random >> 27;
+            if (((random * 0x2545F4914F6CDD1DULL) >> 32) >= threshold)
+                return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr uint32_t PREDICATE_PC = 1 << 0;
+    static constexpr uint32_t PREDICATE_OPCODE = 1 << 1;
+    static constexpr uint32_t PREDICATE_MEMORY = 1 << 2;
+    static constexpr uint64_t RANDOM_ALL = 1ULL << 32;
+
+    static bool test(const uint64_t* map, unsigned bit) {
+        return (map[bit >> 6] >> (bit & 63)) & 1;
+    }
+    static void setRange(uint64_t* map, unsigned first, unsigned last);
+
+    uint32_t kinds = 0;
+    uint32_t every = 1;
+    uint32_t counter = 0;
+    uint64_t threshold = RANDOM_ALL;
+    uint64_t random = 1;
+    uint64_t opcodeMap[512 / 64];
+    uint64_t pcMap[65536 / 64];
+    uint64_t readMap[65536 / 64];
+    uint64_t writeMap[65536 / 64];
+};
+
+#endif // TRACEFILTER_H
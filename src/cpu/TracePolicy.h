@@ -0,0 +1,182 @@
+#ifndef TRACEPOLICY_H
+#define TRACEPOLICY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "TraceFilter.h"
+#include "TraceRecord.h"
+
+// Trace policies plug into CPU::step. The CPU only calls them behind
+// `if constexpr (TracePolicy::enabled)`, so the disabled policy generates no code.
+//
+// Hook order for one instruction:
+//   beginInstruction -> fetched (opcode, operands) -> memoryRead/memoryWrite -> endInstruction
+// and for an interrupt dispatch, which precedes the handler's first instruction:
+//   beginInstruction -> dispatched -> memoryRead/memoryWrite -> endInstruction
+
+// Consumer of full record buffers (e.g. TraceWriter). flush() takes the
+// first `count` records of `records` and returns the buffer to fill next,
+// which has the same capacity. Unless `wait` is set the sink may leave
+// records in the returned buffer, in which case it sets `count` to how many
+// are kept.
+class BufferTrace;
+
+class TraceSink {
+public:
+    virtual ~TraceSink() = default;
+
+    virtual TraceRecord* flush(TraceRecord* records, size_t& count, bool wait) = 0;
+
+    // `trace` stopped sending records here (after its final flush)
+    virtual void detached(BufferTrace*) {}
+};
+
+// Policy used when tracing is compiled out
+struct NullTrace {
+    static constexpr bool enabled = false;
+
+    void beginInstruction(CPURegisters&, uint64_t) {}
+    void fetched(uint8_t) {}
+    void dispatched() {}
+    void memoryRead(uint16_t, uint8_t) {}
+    void memoryWrite(uint16_t, uint8_t) {}
+    void endInstruction(CPURegisters&, uint64_t) {}
+};
+
+// Policy that appends one TraceRecord per retired instruction to a buffer
+// allocated up front. Without a sink, records that do not fit are counted as
+// dropped and the owner drains the buffer with clear(). With a sink attached,
+// a full buffer is handed to the sink between instructions. An optional
+// TraceFilter decides per instruction whether the record is kept; without
+// one the only cost is a null check.
+class BufferTrace {
+public:
+    static constexpr bool enabled = true;
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
+    explicit BufferTrace(size_t capacity = DEFAULT_CAPACITY)
+        : storage(new TraceRecord[capacity]), buffer(storage.get()),
+          capacity(capacity), internalCapacity(capacity)
+    {}
+
+    // Hands the last records to the sink, so the sink must still exist
+    ~BufferTrace() { detach(); }
+
+    void beginInstruction(CPURegisters& regs, uint64_t cycle) {
+        if (count == capacity && sink)
+            buffer = sink->flush(buffer, count, false);
+
+        // Write straight into the next slot; a full buffer writes into scratch instead
+        current = count < capacity ? &buffer[count] : &scratch;
+        current->cycle = cycle;
+        captureRegisters(regs, current->pre);
+        current->pc = current->pre.PC;
+        current->operandCount = 0;
+        current->memCount = 0;
+        current->dispatch = 0;
+        fetchCount = 0;
+    }
+
+    void fetched(uint8_t value) {
+        if (fetchCount++ == 0)
+            current->opcode = value;
+        else if (current->operandCount < 2)
+            current->operands[current->operandCount++] = value;
+    }
+
+    void dispatched() {
+        current->opcode = 0;
+        current->dispatch = 1;
+    }
+
+    void memoryRead(uint16_t address, uint8_t value) { addAccess(address, value, 0); }
+    void memoryWrite(uint16_t address, uint8_t value) { addAccess(address, value, 1); }
+
+    void endInstruction(CPURegisters& regs, uint64_t cycle) {
+        captureRegisters(regs, current->post);
+        current->cycles = static_cast<uint8_t>(cycle - current->cycle);
+        if (filter && !filter->accept(*current)) {
+            filteredCount++;  // Slot is reused by the next instruction
+            return;
+        }
+        if (current != &scratch)
+            count++;
+        else
+            droppedCount++;
+    }
+
+    // Send records to `target`, filling the buffers it hands out
+    void attach(TraceSink* target, TraceRecord* firstBuffer, size_t bufferCapacity) {
+        detach();
+        sink = target;
+        buffer = firstBuffer;
+        capacity = bufferCapacity;
+        count = 0;
+    }
+
+    // Hand buffered records to the sink (if any) without waiting for the buffer to fill
+    void flush() {
+        if (sink && count > 0)
+            buffer = sink->flush(buffer, count, true);
+    }
+
+    // Flush and go back to the internal buffer
+    void detach() {
+        if (!sink)
+            return;
+        flush();
+        TraceSink* previous = sink;
+        sink = nullptr;
+        buffer = storage.get();
+        capacity = internalCapacity;
+        count = 0;
+        previous->detached(this);
+    }
+
+    // Keep only the records `predicate` accepts (copied), or all records again
+    void setFilter(const TraceFilter& predicate) { filter = std::make_unique<TraceFilter>(predicate); }
+    void clearFilter() { filter.reset(); }
+
+    const TraceRecord* records() const { return buffer; }
+    size_t size() const { return count; }
+    size_t getCapacity() const { return capacity; }
+    bool full() const { return count == capacity; }
+    uint64_t dropped() const { return droppedCount; }
+    uint64_t filteredOut() const { return filteredCount; }
+
+    // Discard buffered records so the buffer can be refilled
+    void clear() { count = 0; }
+
+private:
+    void addAccess(uint16_t address, uint8_t value, uint8_t write) {
+        if (current->memCount < TraceRecord::MAX_MEM_ACCESSES) {
+            MemoryAccess& access = current->mem[current->memCount++];
+            access.address = address;
+            access.value = value;
+            access.write = write;
+        }
+    }
+
+    std::unique_ptr<TraceRecord[]> storage;
+    TraceRecord* buffer;
+    size_t capacity;
+    size_t internalCapacity;
+    TraceSink* sink = nullptr;
+    size_t count = 0;
+    uint64_t droppedCount = 0;
+    uint64_t filteredCount = 0;
+    std::unique_ptr<TraceFilter> filter;
+    TraceRecord* current = &scratch;
+    TraceRecord scratch{};
+    int fetchCount = 0;
+};
+
+// Selected at configure time with -DGB_TRACE=ON
+#if defined(GB_TRACE) && GB_TRACE
+using TracePolicy = BufferTrace;
+#else
+using TracePolicy = NullTrace;
+#endif
+
+#endif // TRACEPOLICY_H
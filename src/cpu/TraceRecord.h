@@ -0,0 +1,72 @@
+#ifndef TRACERECORD_H
+#define TRACERECORD_H
+
+#include <cstdint>
+#include "CPURegisters.h"
+
+// Register file snapshot stored in trace records
+struct RegisterSnapshot {
+    uint8_t A, F;
+    uint8_t B, C;
+    uint8_t D, E;
+    uint8_t H, L;
+    uint16_t SP;
+    uint16_t PC;
+};
+
+// Single memory access made by an instruction (opcode/operand fetches excluded)
+struct MemoryAccess {
+    uint16_t address;
+    uint8_t value;
+    uint8_t write;  // 1 = write, 0 = read
+};
+
+// One retired instruction, or one interrupt dispatch: the CPU pushing PC and
+// jumping to the vector (post.PC) fetches no opcode and is recorded on its own,
+// with the IF acknowledge and stack writes as its accesses. The record is fixed
+// size so a buffer of them can be preallocated once and filled without
+// allocation while the CPU runs.
+struct TraceRecord {
+    // Enough for the worst case (interrupt dispatch: IF read + write and 2 pushes)
+    static constexpr int MAX_MEM_ACCESSES = 4;
+
+    uint64_t cycle;              // Cycle counter when the instruction started
+    RegisterSnapshot pre;        // Registers before the instruction
+    RegisterSnapshot post;       // Registers after the instruction
+    MemoryAccess mem[MAX_MEM_ACCESSES];
+    uint16_t pc;                 // Address of the opcode
+    uint8_t opcode;
+    uint8_t operands[2];         // Immediate bytes (CB-prefixed opcode counts as an operand)
+    uint8_t operandCount;
+    uint8_t memCount;            // Accesses stored in mem (saturates at MAX_MEM_ACCESSES)
+    uint8_t cycles;              // Cycles taken by the instruction
+    uint8_t dispatch;            // 1 for an interrupt dispatch (opcode and operands unused)
+};
+
+inline void captureRegisters(CPURegisters& regs, RegisterSnapshot& out) {
+    out.A = regs.getA();
+    out.F = regs.getF();
+    out.B = regs.getB();
+    out.C = regs.getC();
+    out.D = regs.getD();
+    out.E = regs.getE();
+    out.H = regs.getH();
+    out.L = regs.getL();
+    out.SP = regs.getSP();
+    out.PC = regs.getPC();
+}
+
+inline void restoreRegisters(CPURegisters& regs, const RegisterSnapshot& in) {
+    regs.setA(in.A);
+    regs.setF(in.F);
+    regs.setB(in.B);
+    regs.setC(in.C);
+    regs.setD(in.D);
+    regs.setE(in.E);
+    regs.setH(in.H);
+    regs.setL(in.L);
+    regs.setSP(in.SP);
+    regs.setPC(in.PC);
+}
+
+#endif // TRACERECORD_H
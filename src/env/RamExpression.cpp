@@ -0,0 +1,314 @@
+#include "RamExpression.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+void RamExpression::clear() {
+    source.clear();
+    code.clear();
+    deltas = 0;
+}
+
+/////////////////////////  Compiling  ////////////////////////////////
+
+// Split into numbers/names, multi-character operators and single characters
+static bool tokenize(const std::string& text, std::vector<std::string>& tokens, std::vector<size_t>& offsets,
+                     size_t& bad) {
+    static const char* pairs[] = {"&&", "||", "==", "!=", "<=", ">=", "<<", ">>"};
+    size_t i = 0;
+    while (i < text.size()) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (std::isspace(c)) {
+            i++;
+            continue;
+        }
+        size_t start = i;
+        if (std::isalnum(c) || c == '_' || c == '.') {
+            while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '_' ||
+                                       text[i] == '.'))
+                i++;
+        } else if (std::any_of(std::begin(pairs), std::end(pairs),
+                               [&](const char* pair) { return text.compare(i, 2, pair) == 0; })) {
+            i += 2;
+        } else if (std::strchr("+-*/%<>&|^!()[]:,", c)) {
+            i++;
+        } else {
+            bad = i;
+            return false;
+        }
+        tokens.push_back(text.substr(start, i - start));
+        offsets.push_back(start);
+    }
+    return true;
+}
+
+bool RamExpression::compile(const std::string& text) {
+    clear();
+    source = text;
+    tokens.clear();
+    offsets.clear();
+    position = 0;
+    depth = 0;
+    maxDepth = 0;
+    nesting = 0;
+
+    size_t bad = 0;
+    if (!tokenize(text, tokens, offsets, bad)) {
+        std::cerr << "RamExpression::compile failed: unexpected '" << text[bad] << "' at " << bad << " in \""
+                  << text << "\"" << std::endl;
+        clear();
+        return false;
+    }
+    if (tokens.empty())
+        return fail("empty expression");
+    if (!parseBinary(0))
+        return false;
+    if (position < tokens.size())
+        return fail("unexpected '" + tokens[position] + "'");
+    if (maxDepth > MAX_DEPTH)
+        return fail("expression too deeply nested");
+    tokens.clear();
+    offsets.clear();
+    return true;
+}
+
+bool RamExpression::fail(const std::string& message) {
+    size_t at = position < offsets.size() ? offsets[position] : source.size();
+    std::cerr << "RamExpression::compile failed: " << message << " at " << at << " in \"" << source << "\""
+              << std::endl;
+    clear();
+    tokens.clear();
+    offsets.clear();
+    return false;
+}
+
+bool RamExpression::expect(const char* token) {
+    if (position < tokens.size() && tokens[position] == token) {
+        position++;
+        return true;
+    }
+    return fail(std::string("expected '") + token + "'");
+}
+
+void RamExpression::emit(Op op, int pops, int pushes) {
+    Instruction instruction = {};
+    instruction.op = op;
+    code.push_back(instruction);
+    depth += pushes - pops;
+    maxDepth = std::max(maxDepth, depth);
+}
+
+bool RamExpression::parseBinary(size_t level) {
+    static const std::vector<std::vector<std::pair<const char*, Op>>> levels = {
+        {{"||", Op::Or}},
+        {{"&&", Op::And}},
+        {{"|", Op::BitOr}},
+        {{"^", Op::BitXor}},
+        {{"&", Op::BitAnd}},
+        {{"==", Op::Equal}, {"!=", Op::NotEqual}},
+        {{"<", Op::Less}, {"<=", Op::LessEqual}, {">", Op::Greater}, {">=", Op::GreaterEqual}},
+        {{"<<", Op::ShiftLeft}, {">>", Op::ShiftRight}},
+        {{"+", Op::Add}, {"-", Op::Subtract}},
+        {{"*", Op::Multiply}, {"/", Op::Divide}, {"%", Op::Modulo}},
+    };
+    if (level == levels.size())
+        return parseUnary();
+
+    if (!parseBinary(level + 1))
+        return false;
+    for (;;) {
+        if (position >= tokens.size())
+            return true;
+        auto match = std::find_if(levels[level].begin(), levels[level].end(),
+                                  [&](const std::pair<const char*, Op>& entry) {
+                                      return tokens[position] == entry.first;
+                                  });
+        if (match == levels[level].end())
+            return true;
+        position++;
+        if (!parseBinary(level + 1))
+            return false;
+        emit(match->second, 2, 1);
+    }
+}
+
+// Unary operators, parentheses and function arguments all recurse through
+// here, so bounding it keeps hostile input from exhausting the C stack
+bool RamExpression::parseUnary() {
+    if (++nesting > MAX_NESTING)
+        return fail("expression too deeply nested");
+    bool parsed;
+    if (position < tokens.size() && (tokens[position] == "-" || tokens[position] == "!")) {
+        Op op = tokens[position++] == "-" ? Op::Negate : Op::Not;
+        parsed = parseUnary();
+        if (parsed)
+            emit(op, 1, 1);
+    } else {
+        parsed = parsePrimary();
+    }
+    nesting--;
+    return parsed;
+}
+
+// "[ADDR]" or "[ADDR:N]" after an optional "bcd"
+bool RamExpression::parseLoad(bool bcd) {
+    if (!expect("["))
+        return false;
+    if (position >= tokens.size())
+        return fail("expected an address");
+    char* end;
+    unsigned long address = std::strtoul(tokens[position].c_str(), &end, 16);
+    if (*end != '\0' || address > 0xFFFF)
+        return fail("bad address '" + tokens[position] + "'");
+    position++;
+
+    unsigned long bytes = 1;
+    if (position < tokens.size() && tokens[position] == ":") {
+        position++;
+        if (position >= tokens.size())
+            return fail("expected a byte count");
+        bytes = std::strtoul(tokens[position].c_str(), &end, 10);
+        if (*end != '\0' || bytes < 1 || bytes > 4)
+            return fail("byte count must be 1-4");
+        position++;
+    }
+    if (!expect("]"))
+        return false;
+
+    emit(bcd ? Op::LoadBcd : Op::Load, 0, 1);
+    code.back().address = static_cast<uint16_t>(address);
+    code.back().bytes = static_cast<uint8_t>(bytes);
+    return true;
+}
+
+bool RamExpression::parsePrimary() {
+    if (position >= tokens.size())
+        return fail("unexpected end");
+    const std::string token = tokens[position];
+
+    if (token == "(") {
+        position++;
+        return parseBinary(0) && expect(")");
+    }
+    if (token == "[")
+        return parseLoad(false);
+    if (token == "bcd") {
+        position++;
+        return parseLoad(true);
+    }
+    if (std::isdigit(static_cast<unsigned char>(token[0])) || token[0] == '.') {
+        char* end;
+        double value = token.size() > 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X')
+                           ? static_cast<double>(std::strtoul(token.c_str(), &end, 16))
+                           : std::strtod(token.c_str(), &end);
+        if (*end != '\0')
+            return fail("bad number '" + token + "'");
+        position++;
+        emit(Op::Constant, 0, 1);
+        code.back().value = value;
+        return true;
+    }
+
+    // Functions
+    static const struct { const char* name; Op op; int arguments; } functions[] = {
+        {"delta", Op::Delta, 1}, {"abs", Op::Abs, 1}, {"min", Op::Min, 2}, {"max", Op::Max, 2},
+    };
+    for (const auto& function : functions) {
+        if (token != function.name)
+            continue;
+        position++;
+        if (!expect("("))
+            return false;
+        for (int a = 0; a < function.arguments; a++)
+            if ((a && !expect(",")) || !parseBinary(0))
+                return false;
+        if (!expect(")"))
+            return false;
+        emit(function.op, function.arguments, 1);
+        if (function.op == Op::Delta)
+            code.back().slot = deltas++;
+        return true;
+    }
+    return fail("unknown name '" + token + "'");
+}
+
+/////////////////////////  Evaluation  ////////////////////////////////
+
+double RamExpression::evaluate(const uint8_t* memory, double* state) const {
+    double stack[MAX_DEPTH];
+    int top = -1;
+
+    for (const Instruction& in : code) {
+        switch (in.op) {
+            case Op::Constant:
+                stack[++top] = in.value;
+                break;
+            case Op::Load: {
+                uint32_t value = 0;
+                for (int b = in.bytes - 1; b >= 0; b--)
+                    value = (value << 8) | memory[static_cast<uint16_t>(in.address + b)];
+                stack[++top] = value;
+                break;
+            }
+            case Op::LoadBcd: {
+                double value = 0.0;
+                for (int b = in.bytes - 1; b >= 0; b--) {
+                    uint8_t byte = memory[static_cast<uint16_t>(in.address + b)];
+                    value = value * 100.0 + (byte >> 4) * 10 + (byte & 0x0F);
+                }
+                stack[++top] = value;
+                break;
+            }
+            case Op::Delta: {
+                double value = stack[top];
+                stack[top] = value - state[in.slot];
+                state[in.slot] = value;
+                break;
+            }
+            case Op::Negate:
+                stack[top] = -stack[top];
+                break;
+            case Op::Not:
+                stack[top] = stack[top] == 0.0;
+                break;
+            case Op::Abs:
+                stack[top] = std::fabs(stack[top]);
+                break;
+            default: {
+                // Binary operators
+                double b = stack[top--];
+                double& a = stack[top];
+                int64_t x = static_cast<int64_t>(a);
+                int64_t y = static_cast<int64_t>(b);
+                switch (in.op) {
+                    case Op::Min: a = std::min(a, b); break;
+                    case Op::Max: a = std::max(a, b); break;
+                    case Op::Multiply: a = a * b; break;
+                    case Op::Divide: a = b != 0.0 ? a / b : 0.0; break;
+                    case Op::Modulo: a = b != 0.0 ? std::fmod(a, b) : 0.0; break;
+                    case Op::Add: a = a + b; break;
+                    case Op::Subtract: a = a - b; break;
+                    case Op::ShiftLeft: a = static_cast<double>(static_cast<int64_t>(static_cast<uint64_t>(x) << (y & 63))); break;
+                    case Op::ShiftRight: a = static_cast<double>(x >> (y & 63)); break;
+                    case Op::Less: a = a < b; break;
+                    case Op::LessEqual: a = a <= b; break;
+                    case Op::Greater: a = a > b; break;
+                    case Op::GreaterEqual: a = a >= b; break;
+                    case Op::Equal: a = a == b; break;
+                    case Op::NotEqual: a = a != b; break;
+                    case Op::BitAnd: a = static_cast<double>(x & y); break;
+                    case Op::BitXor: a = static_cast<double>(x ^ y); break;
+                    case Op::BitOr: a = static_cast<double>(x | y); break;
+                    case Op::And: a = a != 0.0 && b != 0.0; break;
+                    case Op::Or: a = a != 0.0 || b != 0.0; break;
+                    default: break;
+                }
+                break;
+            }
+        }
+    }
+    return top >= 0 ? stack[top] : 0.0;
+}
@@ -0,0 +1,102 @@
+#ifndef RAMEXPRESSION_H
+#define RAMEXPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Arithmetic over RAM bytes for rewards and episode ends, compiled once into
+// a small stack bytecode that reads the address space directly:
+//   [C0A0]             byte at 0xC0A0 (addresses are hex)
+//   [C0A0:2]           2-byte little-endian value (1-4 bytes)
+//   bcd[C0A0:3]        3 bytes of packed BCD, least significant first
+//   delta(x)           change of x since the previous evaluation
+//   min(a, b) max(a, b) abs(x)
+//   12  0x1F  0.5      numbers (decimal unless 0x)
+// with C operators and precedence: ! - (unary), * / %, + -, << >>,
+// < <= > >=, == !=, &, ^, |, &&, ||. Comparisons and logic give 0 or 1,
+// bitwise operators work on integers and division by zero gives 0.
+//
+// Example: reward "delta(bcd[C0A0:3])" pays the increase of Tetris's BCD
+// score, done "([D000] & 0x80) != 0" ends episodes once bit 7 of 0xD000 is set.
+class RamExpression {
+public:
+    bool compile(const std::string& source);
+    void clear();
+
+    bool empty() const { return code.empty(); }
+    const std::string& text() const { return source; }
+
+    // Values delta() keeps between evaluations, one set per instance
+    size_t stateSize() const { return deltas; }
+
+    // Evaluate against a 64 KiB address space. `state` holds stateSize()
+    // values; reset() primes it so the first delta() is measured from there.
+    double evaluate(const uint8_t* memory, double* state) const;
+    void reset(const uint8_t* memory, double* state) const { evaluate(memory, state); }
+
+private:
+    enum class Op : uint8_t {
+        Constant,
+        Load,      // `bytes` bytes from `address`, little-endian
+        LoadBcd,
+        Delta,     // Replace top with its change since the last time (slot `slot`)
+        Negate,
+        Not,
+        Abs,
+        Min,
+        Max,
+        Multiply,
+        Divide,
+        Modulo,
+        Add,
+        Subtract,
+        ShiftLeft,
+        ShiftRight,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual,
+        Equal,
+        NotEqual,
+        BitAnd,
+        BitXor,
+        BitOr,
+        And,
+        Or
+    };
+
+    struct Instruction {
+        Op op;
+        uint8_t bytes;
+        uint16_t address;
+        uint32_t slot;
+        double value;
+    };
+
+    static constexpr int MAX_DEPTH = 64;     // Evaluation stack
+    static constexpr int MAX_NESTING = 256;  // Parser recursion
+
+    // Parser state (compile() only)
+    bool parseBinary(size_t level);
+    bool parseUnary();
+    bool parsePrimary();
+    bool parseLoad(bool bcd);
+    bool expect(const char* token);
+    bool fail(const std::string& message);
+    void emit(Op op, int pops, int pushes);
+
+    std::string source;
+    std::vector<Instruction> code;
+    uint32_t deltas = 0;
+
+    std::vector<std::string> tokens;
+    std::vector<size_t> offsets;  // Source position of each token
+    size_t position = 0;
+    int depth = 0;
+    int maxDepth = 0;
+    int nesting = 0;
+};
+
+#endif // RAMEXPRESSION_H
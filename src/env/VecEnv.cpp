@@ -0,0 +1,151 @@
+#include "VecEnv.h"
+#include <cstring>
+#include <iostream>
+
+bool VecEnv::open(const std::string& romPath, const VecEnvConfig& settings) {
+    if (settings.envs == 0 || settings.framesPerStep == 0) {
+        std::cerr << "VecEnv::open failed: need at least one instance and one frame per step" << std::endl;
+        return false;
+    }
+    if (!reward.compile(settings.reward.empty() ? "0" : settings.reward) ||
+        !done.compile(settings.done.empty() ? "0" : settings.done))
+        return false;
+    config = settings;
+    instances.clear();
+
+    starter = std::make_unique<GameBoy>();
+    if (!starter->loadROM(romPath))
+        return false;
+    starter->setAudioMode(config.audio);
+    starter->getPPU().setFrameSkip(PPU::RENDER_OFF);
+    starter->saveState(startState);
+    if (!prepareStart())
+        return false;
+
+    instances.resize(config.envs);
+    for (Instance& instance : instances) {
+        instance.gameboy = std::make_unique<GameBoy>();
+        instance.gameboy->setAudioMode(config.audio);
+        instance.gameboy->getPPU().setFrameSkip(PPU::RENDER_OFF);
+        instance.rewardState.assign(reward.stateSize(), 0.0);
+        instance.doneState.assign(done.stateSize(), 0.0);
+        // Start at the first frame so a step() before reset() plays the game
+        resetInstance(instance, nullptr);
+    }
+    pool = std::make_unique<WorkerPool>(config.threads);
+    return true;
+}
+
+bool VecEnv::setStartState(GameBoy& source) {
+    if (!starter) {
+        std::cerr << "VecEnv::setStartState failed: not open" << std::endl;
+        return false;
+    }
+    source.saveState(startState);
+    return prepareStart();
+}
+
+// Run the shared first frame of an episode and keep its result
+bool VecEnv::prepareStart() {
+    firstObservation.assign(observationBytes(), 0);
+    starter->loadState(startState);
+    PPU& ppu = starter->getPPU();
+    if (!ppu.setObservation(config.observation, firstObservation.data()))
+        return false;
+
+    // A start state inside a frame first has to finish that (unrendered) one
+    ppu.requestFrame();
+    starter->runFrame();
+    if (!ppu.frameRendered())
+        starter->runFrame();
+    ppu.clearObservation();
+    starter->saveState(firstFrameState);
+    return true;
+}
+
+void VecEnv::bindObservation(Instance& instance, uint8_t* slot) {
+    if (instance.observation == slot)
+        return;
+    // The spec was validated by prepareStart()
+    instance.gameboy->getPPU().setObservation(config.observation, slot);
+    instance.observation = slot;
+}
+
+void VecEnv::resetInstance(Instance& instance, uint8_t* slot) {
+    instance.gameboy->loadState(firstFrameState);
+    if (slot)
+        memcpy(slot, firstObservation.data(), firstObservation.size());
+    instance.frames = 0;
+    // Plain memory contents: no I/O handlers, no DMA bus lock
+    const uint8_t* memory = instance.gameboy->getMemory().raw();
+    reward.reset(memory, instance.rewardState.data());
+    done.reset(memory, instance.doneState.data());
+}
+
+bool VecEnv::episodeOver(Instance& instance) {
+    if (config.maxEpisodeFrames && instance.frames >= config.maxEpisodeFrames)
+        return true;
+    return done.evaluate(instance.gameboy->getMemory().raw(), instance.doneState.data()) != 0.0;
+}
+
+/////////////////////////  Batch calls  ////////////////////////////////
+
+bool VecEnv::reset(uint8_t* observationArray) {
+    if (instances.empty() || !observationArray) {
+        std::cerr << "VecEnv::reset failed: not open or no observation array" << std::endl;
+        return false;
+    }
+    observations = observationArray;
+    pool->run(instances.size(), resetTask, this);
+    return true;
+}
+
+void VecEnv::resetTask(void* context, size_t index) {
+    VecEnv* env = static_cast<VecEnv*>(context);
+    Instance& instance = env->instances[index];
+    uint8_t* slot = env->observations + index * env->observationBytes();
+    env->bindObservation(instance, slot);
+    env->resetInstance(instance, slot);
+}
+
+bool VecEnv::step(const uint8_t* actionArray, uint8_t* observationArray, float* rewardArray,
+                  uint8_t* doneArray) {
+    if (instances.empty() || !actionArray || !observationArray || !rewardArray || !doneArray) {
+        std::cerr << "VecEnv::step failed: not open or missing an array" << std::endl;
+        return false;
+    }
+    actions = actionArray;
+    observations = observationArray;
+    rewards = rewardArray;
+    dones = doneArray;
+    pool->run(instances.size(), stepTask, this);
+    return true;
+}
+
+void VecEnv::stepTask(void* context, size_t index) {
+    VecEnv* env = static_cast<VecEnv*>(context);
+    const VecEnvConfig& config = env->config;
+    Instance& instance = env->instances[index];
+    uint8_t* slot = env->observations + index * env->observationBytes();
+    env->bindObservation(instance, slot);
+
+    GameBoy& gameboy = *instance.gameboy;
+    gameboy.getJoypad().setButtons(env->actions[index]);
+    double reward = 0.0;
+    bool done = false;
+    for (uint32_t f = 0; f < config.framesPerStep && !done; f++) {
+        // Frames start after runFrame() returns, so this asks for the last one
+        if (f + 1 == config.framesPerStep)
+            gameboy.getPPU().requestFrame();
+        gameboy.runFrame();
+        instance.frames++;
+
+        const uint8_t* memory = gameboy.getMemory().raw();
+        reward += env->reward.evaluate(memory, instance.rewardState.data());
+        done = env->episodeOver(instance);
+    }
+    env->rewards[index] = static_cast<float>(reward);
+    env->dones[index] = done;
+    if (done)
+        env->resetInstance(instance, slot);
+}
@@ -0,0 +1,104 @@
+#ifndef VECENV_H
+#define VECENV_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "RamExpression.h"
+#include "WorkerPool.h"
+#include "gameboy/GameBoy.h"
+#include "ppu/Observation.h"
+
+struct VecEnvConfig {
+    size_t envs = 8;
+    unsigned threads = 0;            // WorkerPool threads (0 = one per hardware thread)
+    uint32_t framesPerStep = 4;      // Frames each action is held for
+    uint64_t maxEpisodeFrames = 0;   // Episodes are cut off after this many frames (0 = never)
+    ObservationSpec observation;
+    std::string reward;              // RamExpression summed over the frames of a step
+    std::string done;                // RamExpression that ends the episode when nonzero
+    AudioMode audio = AudioMode::Off;
+};
+
+// N consoles stepped together for reinforcement learning. One step() call
+// applies an action per instance, runs every instance for framesPerStep
+// frames on a worker pool and writes observations, rewards and done flags
+// into caller-owned arrays, so the per-step cost for the caller is one call
+// regardless of N. Only the last frame of a step is rendered, straight into
+// the caller's observation array.
+//
+// Reward and done expressions are evaluated inside the engine at every frame
+// boundary, so only their results cross to the caller; a step stops early
+// at the frame its episode ends.
+//
+// Instances that finish an episode reset themselves from a stored state:
+// their slots in that step's arrays hold the final reward and done = 1
+// together with the first observation of the next episode. Episodes start
+// one frame after the start state, the frame that provides that first
+// observation; it is rendered once and copied on every reset.
+class VecEnv {
+public:
+    VecEnv() = default;
+
+    // Create the instances with the ROM's power-on state as start state
+    bool open(const std::string& romPath, const VecEnvConfig& config);
+
+    // Start every following episode from `source`'s current state (for
+    // example past a title screen). Takes effect at the next reset.
+    bool setStartState(GameBoy& source);
+
+    // Bytes per instance in the observation array
+    size_t observationBytes() const { return ObservationWriter::bufferBytes(config.observation); }
+    size_t size() const { return instances.size(); }
+    const VecEnvConfig& getConfig() const { return config; }
+
+    // Start a new episode in every instance. `observations` holds
+    // size() * observationBytes() bytes.
+    bool reset(uint8_t* observations);
+
+    // `actions` holds size() button masks (Button bits), `rewards` and `dones`
+    // size() entries each. Pass the same observation array every call: a
+    // different one restarts the stacked frames.
+    bool step(const uint8_t* actions, uint8_t* observations, float* rewards, uint8_t* dones);
+
+    GameBoy& instance(size_t index) { return *instances[index].gameboy; }
+
+private:
+    struct Instance {
+        std::unique_ptr<GameBoy> gameboy;
+        uint8_t* observation = nullptr;  // Slot the PPU writes to
+        uint64_t frames = 0;             // Frames into the current episode
+        std::vector<double> rewardState; // delta() history of the expressions
+        std::vector<double> doneState;
+    };
+
+    static void resetTask(void* context, size_t index);
+    static void stepTask(void* context, size_t index);
+
+    bool prepareStart();
+    void bindObservation(Instance& instance, uint8_t* slot);
+    void resetInstance(Instance& instance, uint8_t* slot);  // slot may be null
+    bool episodeOver(Instance& instance);
+
+    VecEnvConfig config;
+    RamExpression reward;
+    RamExpression done;
+    std::vector<Instance> instances;
+    std::unique_ptr<WorkerPool> pool;
+
+    std::unique_ptr<GameBoy> starter;     // Runs the first frame of an episode
+    GameBoyState startState;              // Where episodes begin
+    GameBoyState firstFrameState;         // One frame later
+    std::vector<uint8_t> firstObservation;
+    bool startReady = false;
+
+    // Arguments of the reset() or step() call in progress
+    const uint8_t* actions = nullptr;
+    uint8_t* observations = nullptr;
+    float* rewards = nullptr;
+    uint8_t* dones = nullptr;
+};
+
+#endif // VECENV_H
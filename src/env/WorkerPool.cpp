@@ -0,0 +1,64 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned t = 1; t < threads; t++)
+        workers.emplace_back(&WorkerPool::loop, this);
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void WorkerPool::run(size_t count, Task task, void* context) {
+    if (workers.empty() || count < 2) {
+        for (size_t i = 0; i < count; i++)
+            task(context, i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = task;
+        this->context = context;
+        this->count = count;
+        next = 0;
+        busy = workers.size();
+        generation++;
+    }
+    wake.notify_all();
+    work();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return busy == 0; });
+}
+
+void WorkerPool::work() {
+    for (size_t i = next++; i < count; i = next++)
+        task(context, i);
+}
+
+void WorkerPool::loop() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [&] { return stopping || generation != seen; });
+        if (stopping)
+            return;
+        seen = generation;
+
+        lock.unlock();
+        work();
+        lock.lock();
+        if (--busy == 0)
+            finished.notify_one();
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads that run one indexed task over [0, count) per call.
+// The calling thread takes part, so a pool of one thread runs everything
+// inline. Indices are handed out one at a time, which keeps the load even
+// when some instances are slower than others.
+class WorkerPool {
+public:
+    using Task = void (*)(void* context, size_t index);
+
+    // `threads` including the caller (0 = one per hardware thread)
+    explicit WorkerPool(unsigned threads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+    // Call task(context, i) for every i below `count`; returns when all are done
+    void run(size_t count, Task task, void* context);
+
+private:
+    void loop();
+    void work();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;      // Workers: new batch or shutdown
+    std::condition_variable finished;  // Caller: last worker left the batch
+    uint64_t generation = 0;           // Batches started so far
+    size_t busy = 0;                   // Workers still in the current batch
+    bool stopping = false;
+
+    Task task = nullptr;
+    void* context = nullptr;
+    size_t count = 0;
+    std::atomic<size_t> next{0};       // Next index to hand out
+};
+
+#endif // WORKERPOOL_H
@@ -0,0 +1,156 @@
+#include "GameBoy.h"
+#include <algorithm>
+#include "profile/PerfCounters.h"
+
+GameBoy::GameBoy()
+    : cpu(&memory, &registers), ppu(&memory), apu(&memory, &cpu), timer(&memory, &cpu, &scheduler),
+      dma(&memory, &cpu, &scheduler), joypad(&memory, &cpu, &scheduler) {
+    cpu.attachInterrupts();
+    ppu.attach(syncPpuHook, this);
+    timer.attach();
+    timer.reset();
+    dma.attach();
+    dma.reset();
+    joypad.attach();
+    joypad.reset();
+    apu.setEventHook(moveApuEvent, this);
+    apu.setMode(AudioMode::Full);
+    apu.reset();
+    resync();
+}
+
+bool GameBoy::loadROM(const std::string& filename) {
+    if (!memory.loadROM(filename))
+        return false;
+    reset();
+    return true;
+}
+
+void GameBoy::reset() {
+    cpu.reset();
+    ppu.reset();
+    timer.reset();
+    dma.reset();
+    joypad.reset();
+    apu.reset();
+    resync();
+}
+
+void GameBoy::setAudioMode(AudioMode mode) {
+    apu.setMode(mode);
+    scheduleApu();
+}
+
+void GameBoy::saveState(GameBoyState& state) {
+    syncPpu();
+
+    state.memory.resize(Memory::MEMORY_SIZE);
+    memory.saveState(state.memory.data());
+    state.registers = registers;
+    state.cpu = cpu.saveState();
+    state.ppu = ppu.saveState();
+    state.apu = apu.saveState();
+    state.timer = timer.saveState();
+    state.dma = dma.saveState();
+    state.joypad = joypad.saveState();
+}
+
+void GameBoy::loadState(const GameBoyState& state) {
+    memory.loadState(state.memory.data());
+    registers = state.registers;
+    cpu.loadState(state.cpu);
+    ppu.loadState(state.ppu);
+    apu.loadState(state.apu);
+    timer.loadState(state.timer);
+    dma.loadState(state.dma);
+    joypad.loadState(state.joypad);
+    joypad.clearQueue();
+    resync();
+}
+
+void GameBoy::resync() {
+    scheduler.clear();
+    cpu.refreshInterrupts();
+    ppuSynced = cpu.getCycles();
+    schedulePpu();
+    timer.reschedule();
+    dma.reschedule();
+    joypad.reschedule();
+    scheduleApu();
+}
+
+// Bring the PPU up to the current cycle
+void GameBoy::syncPpu() {
+    PerfScope scope(perf, PerfPhase::Ppu);
+    const uint64_t now = cpu.getCycles();
+    ppu.step(static_cast<uint32_t>(now - ppuSynced));
+    ppuSynced = now;
+    schedulePpu();
+}
+
+void GameBoy::syncPpuHook(void* context) {
+    static_cast<GameBoy*>(context)->syncPpu();
+}
+
+void GameBoy::schedulePpu() {
+    scheduler.schedule(EventType::PpuMode, ppuSynced + ppu.cyclesUntilEvent());
+}
+
+void GameBoy::scheduleApu() {
+    scheduler.schedule(EventType::ApuSequencer, apu.nextEventTime());
+}
+
+void GameBoy::moveApuEvent(void* context, uint64_t when) {
+    static_cast<GameBoy*>(context)->scheduler.schedule(EventType::ApuSequencer, when);
+}
+
+void GameBoy::dispatchEvents() {
+    const uint64_t now = cpu.getCycles();
+    EventType type;
+    while (scheduler.popDue(now, type)) {
+        switch (type) {
+            case EventType::PpuMode:
+                syncPpu();
+                break;
+            case EventType::TimerOverflow:
+                timer.onOverflow();
+                break;
+            case EventType::DmaComplete:
+                dma.onComplete();
+                break;
+            case EventType::JoypadInput:
+                joypad.onInput();
+                break;
+            case EventType::ApuSequencer:
+                apu.sync();
+                scheduleApu();
+                break;
+            case EventType::Count:
+                break;
+        }
+    }
+}
+
+void GameBoy::step() {
+    cpu.step();
+    // Time passes in HALT up to the event that may end it
+    if (cpu.isIdle())
+        cpu.runUntil(scheduler.nextTime());
+    if (cpu.getCycles() >= scheduler.nextTime())
+        dispatchEvents();
+}
+
+void GameBoy::runUntil(uint64_t target) {
+    while (cpu.getCycles() < target) {
+        cpu.runUntil(std::min(target, scheduler.nextTime()));
+        if (cpu.getCycles() >= scheduler.nextTime())
+            dispatchEvents();
+    }
+}
+
+void GameBoy::runFrame(uint64_t maxCycles) {
+    const uint64_t frames = ppu.getFrames();
+    const uint64_t limit = cpu.getCycles() + maxCycles;
+    while (ppu.getFrames() == frames && cpu.getCycles() < limit)
+        runUntil(std::min(limit, scheduler.nextTime()));
+}
@@ -0,0 +1,104 @@
+#ifndef GAMEBOY_H
+#define GAMEBOY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Joypad.h"
+#include "OamDma.h"
+#include "Scheduler.h"
+#include "Timer.h"
+#include "apu/APU.h"
+#include "cpu/CPU.h"
+#include "cpu/CPURegisters.h"
+#include "memory/Memory.h"
+#include "ppu/PPU.h"
+
+class PerfCounters;
+
+// Whole-console snapshot (episode start states, save states)
+struct GameBoyState {
+    std::vector<uint8_t> memory;  // Memory::MEMORY_SIZE bytes
+    CPURegisters registers;
+    CPUState cpu;
+    PPUState ppu;
+    APUState apu;
+    TimerState timer;
+    OamDmaState dma;
+    JoypadState joypad;
+};
+
+// One emulated console. Subsystems post their next state change to the
+// scheduler and the CPU runs uninterrupted up to the earliest one, instead of
+// every component being ticked after every instruction.
+class GameBoy {
+public:
+    GameBoy();
+
+    bool loadROM(const std::string& filename);
+
+    // Power-on state for the loaded cartridge
+    void reset();
+
+    // Execute one instruction (idling to the next event if the CPU is left
+    // halted) and dispatch the events that became due
+    void step();
+
+    // Run until the cycle counter reaches `target`
+    void runUntil(uint64_t target);
+
+    // Sound emulation level (Full by default). Silent keeps the sound
+    // registers exact without synthesizing audio; Off makes them plain memory
+    // and takes the APU out of the run loop.
+    void setAudioMode(AudioMode mode);
+
+    // Run until the PPU completes another frame (or `maxCycles` pass, for LCD off)
+    void runFrame(uint64_t maxCycles = 2 * 70224);
+
+    // Host counters to charge PPU work to (PerfPhase::Ppu), nullptr for none
+    void setPerfCounters(PerfCounters* counters) { perf = counters; }
+
+    uint64_t getCycles() const { return cpu.getCycles(); }
+
+    CPU& getCPU() { return cpu; }
+    CPURegisters& getRegisters() { return registers; }
+    Memory& getMemory() { return memory; }
+    PPU& getPPU() { return ppu; }
+    APU& getAPU() { return apu; }
+    Timer& getTimer() { return timer; }
+    OamDma& getDma() { return dma; }
+    Joypad& getJoypad() { return joypad; }
+    Scheduler& getScheduler() { return scheduler; }
+
+    // Capture / restore the whole console. Saving brings the PPU up to the
+    // current cycle first; loading drops any queued joypad input. Client
+    // settings (audio mode, frame skip, observations) are left as they are.
+    void saveState(GameBoyState& state);
+    void loadState(const GameBoyState& state);
+
+    // Re-derive pending events after state was replaced (memory or PPU state load)
+    void resync();
+
+private:
+    void dispatchEvents();
+    void syncPpu();
+    static void syncPpuHook(void* context);
+    void schedulePpu();
+    void scheduleApu();
+    static void moveApuEvent(void* context, uint64_t when);
+
+    Memory memory;
+    CPURegisters registers;
+    CPU cpu;
+    PPU ppu;
+    APU apu;
+    Scheduler scheduler;
+    Timer timer;
+    OamDma dma;
+    Joypad joypad;
+
+    uint64_t ppuSynced = 0;  // Cycle the PPU has been advanced to
+    PerfCounters* perf = nullptr;
+};
+
+#endif // GAMEBOY_H
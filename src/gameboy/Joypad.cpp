@@ -0,0 +1,103 @@
+#include "Joypad.h"
+#include <iostream>
+
+static constexpr uint16_t REG_P1 = 0xFF00;
+static constexpr uint16_t REG_IF = 0xFF0F;
+
+Joypad::Joypad(Memory* mem, const CPU* cpu, Scheduler* scheduler)
+    : memory(mem), cpu(cpu), scheduler(scheduler) {
+}
+
+void Joypad::attach() {
+    // Reads return the plain byte, which every change keeps current
+    memory->setIoHandler(REG_P1, nullptr, writeRegister, this);
+}
+
+void Joypad::reset() {
+    buttons = 0;
+    select = 0x30;
+    memory->poke(REG_P1, static_cast<uint8_t>(0xC0 | select | lines()));
+    clearQueue();
+}
+
+JoypadState Joypad::saveState() const {
+    JoypadState state;
+    state.buttons = buttons;
+    state.select = select;
+    return state;
+}
+
+void Joypad::loadState(const JoypadState& state) {
+    buttons = state.buttons;
+    select = state.select;
+    memory->poke(REG_P1, static_cast<uint8_t>(0xC0 | select | lines()));
+}
+
+uint8_t Joypad::lines() const {
+    uint8_t pressed = 0;
+    if (!(select & 0x10))
+        pressed |= buttons & 0x0F;  // Directions
+    if (!(select & 0x20))
+        pressed |= buttons >> 4;    // A, B, Select, Start
+    return static_cast<uint8_t>(~pressed & 0x0F);
+}
+
+void Joypad::update(uint8_t newButtons, uint8_t newSelect) {
+    uint8_t before = lines();
+    buttons = newButtons;
+    select = newSelect;
+    uint8_t after = lines();
+    memory->poke(REG_P1, static_cast<uint8_t>(0xC0 | select | after));
+
+    // The interrupt fires when any input line goes from high to low
+    if (before & ~after)
+        memory->writeByte(REG_IF, memory->readByte(REG_IF) | INT_JOYPAD);
+}
+
+void Joypad::setButtons(uint8_t newButtons) {
+    update(newButtons, select);
+}
+
+bool Joypad::queue(const JoypadInput* inputs, size_t count) {
+    uint64_t last = queued() ? pending.back().cycle : 0;
+    for (size_t i = 0; i < count; i++) {
+        if (inputs[i].cycle < last) {
+            std::cerr << "Joypad::queue failed: input " << i << " at cycle " << inputs[i].cycle
+                      << " is earlier than the one before it" << std::endl;
+            return false;
+        }
+        last = inputs[i].cycle;
+    }
+    pending.insert(pending.end(), inputs, inputs + count);
+    reschedule();
+    return true;
+}
+
+void Joypad::clearQueue() {
+    pending.clear();
+    next = 0;
+    reschedule();
+}
+
+void Joypad::reschedule() {
+    if (queued())
+        scheduler->schedule(EventType::JoypadInput, pending[next].cycle);
+    else
+        scheduler->cancel(EventType::JoypadInput);
+}
+
+void Joypad::onInput() {
+    const uint64_t now = cpu->getCycles();
+    while (queued() && pending[next].cycle <= now)
+        setButtons(pending[next++].buttons);
+    if (!queued()) {
+        pending.clear();
+        next = 0;
+    }
+    reschedule();
+}
+
+void Joypad::writeRegister(void* context, uint16_t, uint8_t value) {
+    Joypad* joypad = static_cast<Joypad*>(context);
+    joypad->update(joypad->buttons, value & 0x30);
+}
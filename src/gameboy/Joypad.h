@@ -0,0 +1,86 @@
+#ifndef JOYPAD_H
+#define JOYPAD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Scheduler.h"
+#include "cpu/CPU.h"
+#include "memory/Memory.h"
+
+// Button bits for Joypad::setButtons() and JoypadInput (1 = pressed)
+enum Button : uint8_t {
+    BUTTON_RIGHT = 0x01,
+    BUTTON_LEFT = 0x02,
+    BUTTON_UP = 0x04,
+    BUTTON_DOWN = 0x08,
+    BUTTON_A = 0x10,
+    BUTTON_B = 0x20,
+    BUTTON_SELECT = 0x40,
+    BUTTON_START = 0x80
+};
+
+// Buttons held from `cycle` on
+struct JoypadInput {
+    uint64_t cycle;
+    uint8_t buttons;
+};
+
+// Joypad state outside memory (save states)
+struct JoypadState {
+    uint8_t buttons;
+    uint8_t select;  // P1 bits 4-5 as last written
+};
+
+// P1 (0xFF00) and the joypad interrupt. Input comes either directly from
+// setButtons() or from a queue of cycle-stamped changes that is applied by a
+// scheduled event, so a whole episode's actions can be handed over at once
+// and the emulator run for many frames without returning to the caller.
+class Joypad {
+public:
+    Joypad(Memory* mem, const CPU* cpu, Scheduler* scheduler);
+
+    // Install the register handler in memory
+    void attach();
+
+    void reset();
+
+    // Change the held buttons now
+    void setButtons(uint8_t buttons);
+    uint8_t getButtons() const { return buttons; }
+
+    // Append changes in cycle order (not before the last queued one). Cycles
+    // already passed take effect at the next event dispatch.
+    bool queue(const JoypadInput* inputs, size_t count);
+    void clearQueue();
+    size_t queued() const { return pending.size() - next; }
+
+    // JoypadInput event: apply every queued change that is due
+    void onInput();
+
+    // Post the event for the next queued change (after state changes)
+    void reschedule();
+
+    JoypadState saveState() const;
+    void loadState(const JoypadState& state);
+
+private:
+    static void writeRegister(void* context, uint16_t address, uint8_t value);
+
+    // P1 input lines 0-3 (0 = pressed in a selected group)
+    uint8_t lines() const;
+    // Store new state, raising the interrupt if a line fell
+    void update(uint8_t newButtons, uint8_t newSelect);
+
+    Memory* memory;
+    const CPU* cpu;
+    Scheduler* scheduler;
+
+    uint8_t buttons = 0;
+    uint8_t select = 0x30;
+
+    std::vector<JoypadInput> pending;  // Client input, not part of the saved state
+    size_t next = 0;                   // First entry of `pending` not yet applied
+};
+
+#endif // JOYPAD_H
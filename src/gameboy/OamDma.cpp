@@ -0,0 +1,62 @@
+#include "OamDma.h"
+
+static constexpr uint16_t REG_DMA = 0xFF46;
+static constexpr uint16_t OAM_START = 0xFE00;
+
+OamDma::OamDma(Memory* mem, const CPU* cpu, Scheduler* scheduler)
+    : memory(mem), cpu(cpu), scheduler(scheduler) {
+}
+
+void OamDma::attach() {
+    // Reads return the plain byte, which the write handler keeps current
+    memory->setIoHandler(REG_DMA, nullptr, writeRegister, this);
+}
+
+void OamDma::reset() {
+    endCycle = Scheduler::NEVER;
+    source = 0xFF;
+    memory->poke(REG_DMA, source);
+    reschedule();
+}
+
+OamDmaState OamDma::saveState() const {
+    OamDmaState state;
+    state.endCycle = endCycle;
+    state.source = source;
+    return state;
+}
+
+void OamDma::loadState(const OamDmaState& state) {
+    endCycle = state.endCycle;
+    source = state.source;
+    reschedule();
+}
+
+void OamDma::reschedule() {
+    memory->lockBus(active());
+    if (active())
+        scheduler->schedule(EventType::DmaComplete, endCycle);
+    else
+        scheduler->cancel(EventType::DmaComplete);
+}
+
+void OamDma::onComplete() {
+    endCycle = Scheduler::NEVER;
+    reschedule();
+}
+
+void OamDma::writeRegister(void* context, uint16_t address, uint8_t value) {
+    OamDma* dma = static_cast<OamDma*>(context);
+    dma->source = value;
+    dma->memory->poke(address, value);
+
+    // Sources above 0xDFFF read the work RAM behind the echo area. A write
+    // while a transfer runs restarts it from the new page.
+    uint16_t from = static_cast<uint16_t>(value << 8);
+    if (from >= 0xE000)
+        from -= 0x2000;
+    dma->memory->copyBlock(OAM_START, from, OAM_BYTES);
+
+    dma->endCycle = dma->cpu->getCycles() + TRANSFER_CYCLES;
+    dma->reschedule();
+}
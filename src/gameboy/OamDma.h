@@ -0,0 +1,54 @@
+#ifndef OAMDMA_H
+#define OAMDMA_H
+
+#include <cstdint>
+#include "Scheduler.h"
+#include "cpu/CPU.h"
+#include "memory/Memory.h"
+
+// OAM DMA state outside memory (save states)
+struct OamDmaState {
+    uint64_t endCycle;  // Cycle the running transfer finishes (Scheduler::NEVER when idle)
+    uint8_t source;     // Last value written to 0xFF46
+};
+
+// OAM DMA (0xFF46). A write copies the 160-byte source page to OAM in one
+// block and locks the CPU out of everything below the I/O page for the 640
+// cycles the hardware takes; the end of the lockout is a scheduled event.
+// Nothing else can change the source while the CPU is locked out, so the
+// copy is indistinguishable from the byte-per-cycle transfer to the program.
+class OamDma {
+public:
+    static constexpr uint16_t OAM_BYTES = 160;
+    static constexpr uint64_t TRANSFER_CYCLES = 640;
+
+    OamDma(Memory* mem, const CPU* cpu, Scheduler* scheduler);
+
+    // Install the register handler in memory
+    void attach();
+
+    void reset();
+
+    // DmaComplete event
+    void onComplete();
+
+    // Post the completion event and bus lock for the current state (after state changes)
+    void reschedule();
+
+    bool active() const { return endCycle != Scheduler::NEVER; }
+
+    OamDmaState saveState() const;
+    void loadState(const OamDmaState& state);
+
+private:
+    static void writeRegister(void* context, uint16_t address, uint8_t value);
+
+    Memory* memory;
+    const CPU* cpu;
+    Scheduler* scheduler;
+
+    uint64_t endCycle = Scheduler::NEVER;
+    uint8_t source = 0xFF;
+};
+
+#endif // OAMDMA_H
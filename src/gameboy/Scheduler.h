@@ -0,0 +1,74 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <cstdint>
+
+// Subsystem events, at most one pending per type
+enum class EventType : uint8_t {
+    PpuMode,         // PPU mode change / LY increment
+    TimerOverflow,   // TIMA overflow
+    DmaComplete,     // OAM DMA finished
+    ApuSequencer,    // APU frame sequencer step
+    JoypadInput,     // Queued joypad change due
+    Count
+};
+
+static constexpr int EVENT_TYPES = static_cast<int>(EventType::Count);
+
+// Cycle-timestamped events. With one slot per type the queue is a handful of
+// timestamps: scheduling rescans them for the earliest, and the run loop only
+// compares the CPU cycle counter against nextTime().
+class Scheduler {
+public:
+    static constexpr uint64_t NEVER = UINT64_MAX;
+
+    // Post (or move) the event of `type` to absolute cycle `when`
+    void schedule(EventType type, uint64_t when) {
+        times[static_cast<int>(type)] = when;
+        refresh();
+    }
+
+    void cancel(EventType type) {
+        times[static_cast<int>(type)] = NEVER;
+        refresh();
+    }
+
+    bool pending(EventType type) const { return times[static_cast<int>(type)] != NEVER; }
+    uint64_t when(EventType type) const { return times[static_cast<int>(type)]; }
+
+    // Cycle of the earliest pending event (NEVER when idle)
+    uint64_t nextTime() const { return next; }
+
+    // Remove and return the earliest event if it is due at `now`
+    bool popDue(uint64_t now, EventType& type) {
+        if (next > now)
+            return false;
+        type = static_cast<EventType>(nextType);
+        times[nextType] = NEVER;
+        refresh();
+        return true;
+    }
+
+    void clear() {
+        for (uint64_t& time : times)
+            time = NEVER;
+        refresh();
+    }
+
+private:
+    void refresh() {
+        next = NEVER;
+        nextType = 0;
+        for (int i = 0; i < EVENT_TYPES; i++)
+            if (times[i] < next) {
+                next = times[i];
+                nextType = i;
+            }
+    }
+
+    uint64_t times[EVENT_TYPES] = {NEVER, NEVER, NEVER, NEVER, NEVER};
+    uint64_t next = NEVER;
+    int nextType = 0;
+};
+
+#endif // SCHEDULER_H
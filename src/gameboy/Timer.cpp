@@ -0,0 +1,152 @@
+#include "Timer.h"
+
+static constexpr uint16_t REG_DIV = 0xFF04;
+static constexpr uint16_t REG_TIMA = 0xFF05;
+static constexpr uint16_t REG_TMA = 0xFF06;
+static constexpr uint16_t REG_TAC = 0xFF07;
+static constexpr uint16_t REG_IF = 0xFF0F;
+
+// Divider cycles per TIMA increment for TAC bits 0-1
+static constexpr uint64_t TIMA_PERIOD[4] = {1024, 16, 64, 256};
+
+Timer::Timer(Memory* mem, const CPU* cpu, Scheduler* scheduler)
+    : memory(mem), cpu(cpu), scheduler(scheduler) {
+}
+
+void Timer::attach() {
+    for (uint16_t address = REG_DIV; address <= REG_TAC; address++)
+        memory->setIoHandler(address, readRegister, writeRegister, this);
+}
+
+void Timer::reset() {
+    divBase = now();
+    timaSynced = 0;
+    tima = 0;
+    tma = 0;
+    tac = 0;
+    mirror(now());
+    reschedule();
+}
+
+TimerState Timer::saveState() const {
+    TimerState state;
+    state.divBase = divBase;
+    state.timaSynced = timaSynced;
+    state.tima = tima;
+    state.tma = tma;
+    state.tac = tac;
+    return state;
+}
+
+void Timer::loadState(const TimerState& state) {
+    divBase = state.divBase;
+    timaSynced = state.timaSynced;
+    tima = state.tima;
+    tma = state.tma;
+    tac = state.tac;
+    reschedule();
+}
+
+void Timer::advance(uint64_t increments) {
+    uint64_t total = tima + increments;
+    if (total <= 0xFF) {
+        tima = static_cast<uint8_t>(total);
+        return;
+    }
+    // Wrapped at least once: counting continues from TMA
+    uint64_t span = 0x100 - tma;
+    tima = static_cast<uint8_t>(tma + (total - 0x100) % span);
+    memory->writeByte(REG_IF, memory->readByte(REG_IF) | 0x04);
+}
+
+void Timer::sync(uint64_t cycle) {
+    uint64_t count = divider(cycle);
+    if (tac & 0x04) {
+        // Falling edges of the selected bit are the multiples of its period
+        uint64_t period = TIMA_PERIOD[tac & 3];
+        if (uint64_t increments = count / period - timaSynced / period)
+            advance(increments);
+    }
+    timaSynced = count;
+}
+
+// Whether the divider bit TIMA counts on is high (0 while the timer is off)
+bool Timer::selectedBit(uint64_t cycle) const {
+    return (tac & 0x04) && (divider(cycle) & (TIMA_PERIOD[tac & 3] / 2));
+}
+
+// Keep the plain bytes current for snapshots and trace keyframes
+void Timer::mirror(uint64_t cycle) {
+    memory->poke(REG_DIV, static_cast<uint8_t>(divider(cycle) >> 8));
+    memory->poke(REG_TIMA, tima);
+    memory->poke(REG_TMA, tma);
+    memory->poke(REG_TAC, static_cast<uint8_t>(0xF8 | tac));
+}
+
+void Timer::reschedule() {
+    if (!(tac & 0x04)) {
+        scheduler->cancel(EventType::TimerOverflow);
+        return;
+    }
+    // The overflow happens on the (0x100 - TIMA)th falling edge from here
+    uint64_t period = TIMA_PERIOD[tac & 3];
+    uint64_t edge = (timaSynced / period + (0x100 - tima)) * period;
+    scheduler->schedule(EventType::TimerOverflow, divBase + edge);
+}
+
+void Timer::onOverflow() {
+    uint64_t cycle = now();
+    sync(cycle);
+    mirror(cycle);
+    reschedule();
+}
+
+uint8_t Timer::readRegister(void* context, uint16_t address) {
+    Timer* timer = static_cast<Timer*>(context);
+    uint64_t cycle = timer->now();
+    switch (address) {
+        case REG_DIV:
+            return static_cast<uint8_t>(timer->divider(cycle) >> 8);
+        case REG_TIMA:
+            timer->sync(cycle);
+            timer->mirror(cycle);
+            return timer->tima;
+        case REG_TMA:
+            return timer->tma;
+        default:
+            return static_cast<uint8_t>(0xF8 | timer->tac);
+    }
+}
+
+void Timer::writeRegister(void* context, uint16_t address, uint8_t value) {
+    Timer* timer = static_cast<Timer*>(context);
+    uint64_t cycle = timer->now();
+    timer->sync(cycle);
+
+    // Resetting the divider or changing TAC can take the selected bit from
+    // 1 to 0, which the hardware counts as an edge
+    switch (address) {
+        case REG_DIV:
+            if (timer->selectedBit(cycle))
+                timer->advance(1);
+            timer->divBase = cycle;
+            timer->timaSynced = 0;
+            break;
+        case REG_TIMA:
+            timer->tima = value;
+            break;
+        case REG_TMA:
+            timer->tma = value;
+            break;
+        default: {
+            bool wasHigh = timer->selectedBit(cycle);
+            timer->tac = value & 0x07;
+            if (wasHigh && !timer->selectedBit(cycle))
+                timer->advance(1);
+            break;
+        }
+    }
+
+    timer->mirror(cycle);
+    timer->reschedule();
+}
@@ -0,0 +1,65 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <cstdint>
+#include "Scheduler.h"
+#include "cpu/CPU.h"
+#include "memory/Memory.h"
+
+// Timer state outside memory (save states)
+struct TimerState {
+    uint64_t divBase;     // Cycle at which the divider was last reset
+    uint64_t timaSynced;  // Divider count TIMA is up to date with
+    uint8_t tima;
+    uint8_t tma;
+    uint8_t tac;
+};
+
+// DIV/TIMA/TMA/TAC (0xFF04-0xFF07), evaluated lazily. The 16-bit divider is
+// the cycle count since it was last reset and TIMA counts falling edges of
+// the divider bit selected by TAC, so both are computed from timestamps when
+// read. The only scheduled work is one event at the next TIMA overflow.
+class Timer {
+public:
+    Timer(Memory* mem, const CPU* cpu, Scheduler* scheduler);
+
+    // Install the register handlers in memory
+    void attach();
+
+    void reset();
+
+    // TimerOverflow event
+    void onOverflow();
+
+    // Post the overflow event for the current settings (after state changes)
+    void reschedule();
+
+    TimerState saveState() const;
+    void loadState(const TimerState& state);
+
+private:
+    static uint8_t readRegister(void* context, uint16_t address);
+    static void writeRegister(void* context, uint16_t address, uint8_t value);
+
+    uint64_t now() const { return cpu->getCycles(); }
+    uint64_t divider(uint64_t cycle) const { return cycle - divBase; }
+
+    // Bring TIMA up to `cycle`
+    void sync(uint64_t cycle);
+    // Count TIMA up, reloading from TMA and raising the interrupt on overflow
+    void advance(uint64_t increments);
+    bool selectedBit(uint64_t cycle) const;
+    void mirror(uint64_t cycle);
+
+    Memory* memory;
+    const CPU* cpu;
+    Scheduler* scheduler;
+
+    uint64_t divBase = 0;
+    uint64_t timaSynced = 0;
+    uint8_t tima = 0;
+    uint8_t tma = 0;
+    uint8_t tac = 0;
+};
+
+#endif // TIMER_H
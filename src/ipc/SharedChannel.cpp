@@ -0,0 +1,243 @@
+#include "SharedChannel.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// Polls before sleeping; a step answered within this many spins never
+// pays for a futex wait and wakeup. On a single CPU spinning only delays
+// the other side, so it is skipped there.
+static const int SPIN_LIMIT = std::thread::hardware_concurrency() > 1 ? 4000 : 0;
+
+// Interval at which a waiting trainer checks that the server still exists
+static constexpr int LIVENESS_MS = 100;
+
+static uint32_t* word(std::atomic<uint32_t>& value) {
+    return reinterpret_cast<uint32_t*>(&value);
+}
+
+// Sleep while `value` still holds `expected` (shared futex: the words are
+// in a segment mapped by two processes)
+static void futexWait(std::atomic<uint32_t>& value, uint32_t expected, int timeoutMs) {
+    timespec timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000;
+    syscall(SYS_futex, word(value), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+static void futexWake(std::atomic<uint32_t>& value) {
+    syscall(SYS_futex, word(value), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+}
+
+static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Wait up to `timeoutMs` for `value` to move away from `current`
+static bool waitChange(std::atomic<uint32_t>& value, uint32_t current, int timeoutMs) {
+    for (int spin = 0; spin < SPIN_LIMIT; spin++) {
+        if (value.load(std::memory_order_acquire) != current)
+            return true;
+        cpuRelax();
+    }
+    futexWait(value, current, timeoutMs);
+    return value.load(std::memory_order_acquire) != current;
+}
+
+static bool processAlive(int32_t pid) {
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+static size_t align64(size_t offset) {
+    return (offset + 63) & ~static_cast<size_t>(63);
+}
+
+SharedChannel::Layout SharedChannel::makeLayout(uint32_t envs, size_t observationBytes) {
+    Layout layout;
+    layout.envs = envs;
+    layout.observationBytes = static_cast<uint32_t>(observationBytes);
+    layout.actionsOffset = align64(sizeof(ChannelHeader));
+    layout.observationsOffset = align64(layout.actionsOffset + envs);
+    layout.rewardsOffset = align64(layout.observationsOffset + envs * observationBytes);
+    layout.donesOffset = align64(layout.rewardsOffset + envs * sizeof(float));
+    layout.totalBytes = align64(layout.donesOffset + envs);
+    return layout;
+}
+
+SharedChannel::~SharedChannel() {
+    close();
+}
+
+bool SharedChannel::map(int fd, size_t bytes) {
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED)
+        return false;
+    base = static_cast<uint8_t*>(memory);
+    header = reinterpret_cast<ChannelHeader*>(base);
+    mappedBytes = bytes;
+    return true;
+}
+
+bool SharedChannel::create(const std::string& name, uint32_t envs, uint32_t width, uint32_t height,
+                           uint32_t stack) {
+    close();
+    const Layout arrays = makeLayout(envs, static_cast<size_t>(width) * height * stack);
+    const size_t totalBytes = arrays.totalBytes;
+
+    // A segment left behind by a crashed server is replaced, not reused
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 || ftruncate(fd, static_cast<off_t>(totalBytes)) != 0 || !map(fd, totalBytes)) {
+        std::cerr << "SharedChannel::create failed for " << name << ": " << strerror(errno) << std::endl;
+        if (fd >= 0) {
+            ::close(fd);
+            shm_unlink(name.c_str());
+        }
+        return false;
+    }
+    ::close(fd);
+    segmentName = name;
+    owner = true;
+    layout = arrays;
+
+    new (header) ChannelHeader();
+    header->version = ChannelHeader::VERSION;
+    header->envs = envs;
+    header->observationBytes = arrays.observationBytes;
+    header->width = width;
+    header->height = height;
+    header->stack = stack;
+    header->serverPid = static_cast<int32_t>(getpid());
+    header->actionsOffset = arrays.actionsOffset;
+    header->observationsOffset = arrays.observationsOffset;
+    header->rewardsOffset = arrays.rewardsOffset;
+    header->donesOffset = arrays.donesOffset;
+    header->totalBytes = totalBytes;
+    header->trainerPid.store(0);
+    header->request.store(0);
+    header->response.store(0);
+    header->magic.store(ChannelHeader::MAGIC, std::memory_order_release);
+    return true;
+}
+
+bool SharedChannel::open(const std::string& name) {
+    close();
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        std::cerr << "SharedChannel::open failed for " << name << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+    // Map the header alone first to learn the layout, which must be the one
+    // this version of create() produces
+    bool ok = map(fd, sizeof(ChannelHeader)) && header->magic.load(std::memory_order_acquire) == ChannelHeader::MAGIC &&
+              header->version == ChannelHeader::VERSION;
+    Layout arrays;
+    if (ok) {
+        arrays = makeLayout(header->envs, header->observationBytes);
+        ok = header->actionsOffset == arrays.actionsOffset &&
+             header->observationsOffset == arrays.observationsOffset &&
+             header->rewardsOffset == arrays.rewardsOffset && header->donesOffset == arrays.donesOffset &&
+             header->totalBytes == arrays.totalBytes;
+    }
+    size_t totalBytes = ok ? arrays.totalBytes : 0;
+    if (header)
+        munmap(base, mappedBytes);
+    base = nullptr;
+    header = nullptr;
+    ok = ok && map(fd, totalBytes);
+    ::close(fd);
+    if (!ok) {
+        std::cerr << "SharedChannel::open failed: " << name << " is not a published channel of this version"
+                  << std::endl;
+        close();
+        return false;
+    }
+
+    const int32_t self = static_cast<int32_t>(getpid());
+    int32_t attached = 0;
+    if (!header->trainerPid.compare_exchange_strong(attached, self) &&
+        (processAlive(attached) || !header->trainerPid.compare_exchange_strong(attached, self))) {
+        std::cerr << "SharedChannel::open failed: " << name << " is in use by process " << attached << std::endl;
+        close();
+        return false;
+    }
+    segmentName = name;
+    layout = arrays;
+    return true;
+}
+
+void SharedChannel::close() {
+    if (header && !owner) {
+        int32_t self = static_cast<int32_t>(getpid());
+        header->trainerPid.compare_exchange_strong(self, 0);
+    }
+    if (base)
+        munmap(base, mappedBytes);
+    if (owner)
+        shm_unlink(segmentName.c_str());
+    base = nullptr;
+    header = nullptr;
+    mappedBytes = 0;
+    segmentName.clear();
+    owner = false;
+    layout = Layout();
+}
+
+/////////////////////////  Exchange  ////////////////////////////////
+
+bool SharedChannel::call(ChannelCommand command) {
+    if (!header) {
+        std::cerr << "SharedChannel::call failed: not open" << std::endl;
+        return false;
+    }
+    header->command = command;
+    const uint32_t request = header->request.load(std::memory_order_relaxed) + 1;
+    header->request.store(request, std::memory_order_release);
+    futexWake(header->request);
+
+    for (;;) {
+        uint32_t response = header->response.load(std::memory_order_acquire);
+        if (response == request)
+            break;
+        if (!waitChange(header->response, response, LIVENESS_MS) && !processAlive(header->serverPid)) {
+            std::cerr << "SharedChannel::call failed: server process " << header->serverPid << " exited"
+                      << std::endl;
+            return false;
+        }
+    }
+    if (header->status != 0) {
+        std::cerr << "SharedChannel::call failed: server reported error " << header->status << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool SharedChannel::waitRequest(uint32_t lastRequest, uint32_t& request, int timeoutMs) {
+    if (header->request.load(std::memory_order_acquire) == lastRequest &&
+        !waitChange(header->request, lastRequest, timeoutMs))
+        return false;
+    request = header->request.load(std::memory_order_acquire);
+    return true;
+}
+
+void SharedChannel::respond(uint32_t request, uint32_t status) {
+    header->status = status;
+    header->response.store(request, std::memory_order_release);
+    futexWake(header->response);
+}
+
+void SharedChannel::releaseDeadTrainer() {
+    int32_t attached = header->trainerPid.load();
+    if (attached && !processAlive(attached))
+        header->trainerPid.compare_exchange_strong(attached, 0);
+}
@@ -0,0 +1,120 @@
+#ifndef SHAREDCHANNEL_H
+#define SHAREDCHANNEL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Requests a trainer can make on a channel
+enum class ChannelCommand : uint32_t {
+    Reset,  // Start new episodes, fill observations
+    Step    // Apply actions, fill observations, rewards and dones
+};
+
+// Start of a channel's shared-memory segment. The arrays follow at the
+// given offsets; every field before `request` is written once by the server
+// before it publishes `magic`.
+struct ChannelHeader {
+    static constexpr uint32_t MAGIC = 0x47424348;  // "GBCH"
+    static constexpr uint32_t VERSION = 1;
+
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t envs;
+    uint32_t observationBytes;  // Per instance
+    uint32_t width;             // Observation shape (stack x height x width)
+    uint32_t height;
+    uint32_t stack;
+    int32_t serverPid;
+    uint64_t actionsOffset;       // envs button masks
+    uint64_t observationsOffset;  // envs * observationBytes bytes
+    uint64_t rewardsOffset;       // envs floats
+    uint64_t donesOffset;         // envs bytes
+    uint64_t totalBytes;
+
+    std::atomic<int32_t> trainerPid;  // Trainer attached to the channel (0 = none)
+    ChannelCommand command;           // Written by the trainer before `request`
+    uint32_t status;                  // 0 when the last command succeeded
+
+    // Futex words on their own cache lines: the trainer bumps `request`, the
+    // server sets `response` to the request it finished
+    alignas(64) std::atomic<uint32_t> request;
+    alignas(64) std::atomic<uint32_t> response;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "futex words must be plain 32-bit integers");
+
+// One trainer <-> server link through a POSIX shared-memory segment
+// (/dev/shm/<name>). A step is a mailbox exchange: the trainer writes its
+// actions and bumps `request`, the server runs the step straight into the
+// shared arrays and publishes `response`. Each side spins briefly and then
+// sleeps on a futex, so a waiting process costs nothing and a wakeup takes
+// microseconds. Either side notices the other's death through its pid,
+// and a trainer can attach again after the previous one exited.
+class SharedChannel {
+public:
+    SharedChannel() = default;
+    ~SharedChannel();
+
+    SharedChannel(const SharedChannel&) = delete;
+    SharedChannel& operator=(const SharedChannel&) = delete;
+
+    // Server: create (replacing any stale segment of that name) and publish
+    bool create(const std::string& name, uint32_t envs, uint32_t width, uint32_t height, uint32_t stack);
+
+    // Trainer: attach to a published channel. Fails while another live
+    // trainer is attached.
+    bool open(const std::string& name);
+
+    // Unmap; the server also removes the segment name
+    void close();
+
+    bool isOpen() const { return header != nullptr; }
+    const ChannelHeader& info() const { return *header; }
+
+    // Array layout as of create()/open(). The header copies are writable by
+    // the other process, so they are never consulted again.
+    uint32_t envs() const { return layout.envs; }
+    uint8_t* actions() { return base + layout.actionsOffset; }
+    uint8_t* observations() { return base + layout.observationsOffset; }
+    float* rewards() { return reinterpret_cast<float*>(base + layout.rewardsOffset); }
+    uint8_t* dones() { return base + layout.donesOffset; }
+
+    // Trainer: run `command` on the server and wait for it. Fails if the
+    // server exits or reports an error.
+    bool call(ChannelCommand command);
+
+    // Server: wait up to `timeoutMs` for a request after `lastRequest`.
+    // Returns false on timeout; `request` receives the new request number.
+    bool waitRequest(uint32_t lastRequest, uint32_t& request, int timeoutMs);
+
+    // Server: report `request` finished with `status`
+    void respond(uint32_t request, uint32_t status);
+
+    // Server: detach a trainer that exited without closing
+    void releaseDeadTrainer();
+
+private:
+    struct Layout {
+        uint32_t envs = 0;
+        uint32_t observationBytes = 0;
+        size_t actionsOffset = 0;
+        size_t observationsOffset = 0;
+        size_t rewardsOffset = 0;
+        size_t donesOffset = 0;
+        size_t totalBytes = 0;
+    };
+
+    static Layout makeLayout(uint32_t envs, size_t observationBytes);
+    bool map(int fd, size_t bytes);
+
+    uint8_t* base = nullptr;
+    ChannelHeader* header = nullptr;
+    size_t mappedBytes = 0;
+    std::string segmentName;
+    bool owner = false;
+    Layout layout;
+};
+
+#endif // SHAREDCHANNEL_H
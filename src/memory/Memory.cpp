@@ -1,38 +1,107 @@
-#include "Memory.h"
-#include <fstream>
-#include <iostream>
-#include <cstring>
-
-Memory::Memory() {
-    // Initialize all memory to 0xFF by default
-    memset(data, 0xFF, MEMORY_SIZE);
-}
-
-bool Memory::loadROM(const std::string& filename) {
-    std::ifstream file(filename, std::ios::binary | std::ios::in);
-    if (!file.is_open()) {
-        std::cerr << "Memory::loadROM failed to open " << filename << std::endl;
-        return false;
-    }
-
-    // Read ROM into beginning of memory
-    file.read(reinterpret_cast<char*>(data), MEMORY_SIZE);
-
-    if (file.bad()) {
-        std::cerr << "Memory::loadROM error reading " << filename << std::endl;
-        return false;
-    }
-
-    file.close();
-    return true;
-}
-
-uint8_t Memory::readByte(uint16_t address) const {
-    // Simple bounds check could be added if desired
-    return data[address];
-}
-
-void Memory::writeByte(uint16_t address, uint8_t value) {
-    // For now allow write everywhere  memory mapping and cartridge restrictions will come later
-    data[address] = value;
+#include "Memory.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+Memory::Memory() {
+    // Initialize all memory to 0xFF by default
+    memset(data, 0xFF, MEMORY_SIZE);
+    markAllTilesDirty();
+}
+
+void Memory::markAllTilesDirty() {
+    memset(tileDirty, 0xFF, sizeof(tileDirty));
+}
+
+bool Memory::loadROM(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::in);
+    if (!file.is_open()) {
+        std::cerr << "Memory::loadROM failed to open " << filename << std::endl;
+        return false;
+    }
+
+    // Read ROM into beginning of memory
+    file.read(reinterpret_cast<char*>(data), MEMORY_SIZE);
+
+    if (file.bad()) {
+        std::cerr << "Memory::loadROM error reading " << filename << std::endl;
+        return false;
+    }
+
+    file.close();
+    markAllTilesDirty();
+    return true;
+}
+
+uint8_t Memory::readByte(uint16_t address) const {
+    if (address >= handledFrom) {
+        if (address < 0xFF00)
+            return 0xFF;  // Bus locked
+        const IoHandler& handler = io[address & 0xFF];
+        if (handler.read)
+            return handler.read(handler.context, address);
+    }
+    return data[address];
+}
+
+void Memory::writeByte(uint16_t address, uint8_t value) {
+    // For now allow write everywhere  memory mapping and cartridge restrictions will come later
+    if (address >= handledFrom) {
+        if (address < 0xFF00)
+            return;  // Bus locked
+        const IoHandler& handler = io[address & 0xFF];
+        if (handler.write) {
+            handler.write(handler.context, address, value);
+            return;
+        }
+    }
+    data[address] = value;
+    unsigned offset = address - 0x8000u;
+    if (offset < VRAM_TILES * 16u) {
+        unsigned tile = offset >> 4;
+        tileDirty[tile >> 6] |= 1ULL << (tile & 63);
+    }
+}
+
+void Memory::copyBlock(uint16_t destination, uint16_t source, uint16_t length) {
+    if (destination + length > MEMORY_SIZE || source + length > MEMORY_SIZE) {
+        std::cerr << "Memory::copyBlock failed: block runs past the end of memory" << std::endl;
+        return;
+    }
+    memmove(data + destination, data + source, length);
+    markTilesDirty(destination, length);
+}
+
+void Memory::markTilesDirty(uint16_t address, uint16_t length) {
+    const unsigned begin = std::max<unsigned>(address, 0x8000u);
+    const unsigned end = std::min<unsigned>(address + length, 0x8000u + VRAM_TILES * 16u);
+    for (unsigned tile = (begin - 0x8000u) >> 4; begin < end && tile <= (end - 1 - 0x8000u) >> 4; tile++)
+        tileDirty[tile >> 6] |= 1ULL << (tile & 63);
+}
+
+void Memory::setIoHandler(uint16_t address, IoReadHandler read, IoWriteHandler write, void* context) {
+    if (address < 0xFF00) {
+        std::cerr << "Memory::setIoHandler failed: 0x" << std::hex << address << std::dec
+                  << " is outside the I/O page" << std::endl;
+        return;
+    }
+    IoHandler& handler = io[address & 0xFF];
+    handler.read = read;
+    handler.write = write;
+    handler.context = context;
+}
+
+void Memory::clearIoHandlers() {
+    for (IoHandler& handler : io)
+        handler = IoHandler();
+}
+
+void Memory::saveState(uint8_t* out) const {
+    memcpy(out, data, MEMORY_SIZE);
+}
+
+void Memory::loadState(const uint8_t* in) {
+    memcpy(data, in, MEMORY_SIZE);
+    markAllTilesDirty();
 }
\ No newline at end of file
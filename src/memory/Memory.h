@@ -1,26 +1,76 @@
-#ifndef MEMORY_H
-#define MEMORY_H
-
-#include <cstdint>
-#include <string>
-
-class Memory {
-public:
-    Memory();
-
-    // Load ROM from file into memory at 0x0000
-    bool loadROM(const std::string& filename);
-
-    // Read one byte from memory address
-    uint8_t readByte(uint16_t address) const;
-
-    // Write one byte to memory address
-    void writeByte(uint16_t address, uint8_t value);
-
-private:
-    static constexpr size_t MEMORY_SIZE = 65536; // 64KB
-
-    uint8_t data[MEMORY_SIZE];
-};
-
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <cstdint>
+#include <string>
+
+class Memory {
+public:
+    Memory();
+
+    // Load ROM from file into memory at 0x0000
+    bool loadROM(const std::string& filename);
+
+    // Read one byte from memory address
+    uint8_t readByte(uint16_t address) const;
+
+    // Write one byte to memory address
+    void writeByte(uint16_t address, uint8_t value);
+
+    // Hardware registers with side effects in the 0xFF00-0xFFFF page. A read
+    // handler supplies the value the CPU sees, a write handler replaces the
+    // plain store; either may be null to keep the default behaviour.
+    using IoReadHandler = uint8_t (*)(void* context, uint16_t address);
+    using IoWriteHandler = void (*)(void* context, uint16_t address, uint8_t value);
+    void setIoHandler(uint16_t address, IoReadHandler read, IoWriteHandler write, void* context);
+    void clearIoHandlers();
+
+    // Store a register byte without going through its handler (devices
+    // updating their own registers, snapshot mirrors)
+    void poke(uint16_t address, uint8_t value) { data[address] = value; }
+
+    // Copy `length` bytes inside the address space without going through
+    // handlers or the bus lock (DMA transfers)
+    void copyBlock(uint16_t destination, uint16_t source, uint16_t length);
+
+    // While locked (OAM DMA) the CPU only reaches the 0xFF00-0xFFFF page:
+    // reads below it return 0xFF and writes are dropped
+    void lockBus(bool locked) { handledFrom = locked ? 0x0000 : 0xFF00; }
+    bool busLocked() const { return handledFrom == 0x0000; }
+
+    // Direct view of the address space for bulk readers (PPU rendering)
+    const uint8_t* raw() const { return data; }
+
+    // ROM bank mapped at 0x4000-0x7FFF (no MBC is emulated yet, so always 1)
+    uint16_t romBank() const { return 1; }
+
+    // Copy the whole address space out of / into memory (snapshots, trace keyframes)
+    void saveState(uint8_t* out) const;
+    void loadState(const uint8_t* in);
+
+    static constexpr size_t MEMORY_SIZE = 65536; // 64KB
+
+    // Tile data (0x8000-0x97FF) as 384 tiles of 16 bytes; writes set the
+    // tile's bit and the PPU's tile cache clears the bits it has decoded
+    static constexpr int VRAM_TILES = 384;
+    static constexpr int DIRTY_WORDS = VRAM_TILES / 64;
+    uint64_t* dirtyTiles() { return tileDirty; }
+
+private:
+    void markAllTilesDirty();
+
+    struct IoHandler {
+        IoReadHandler read = nullptr;
+        IoWriteHandler write = nullptr;
+        void* context = nullptr;
+    };
+
+    void markTilesDirty(uint16_t address, uint16_t length);
+
+    uint8_t data[MEMORY_SIZE];
+    uint64_t tileDirty[DIRTY_WORDS];
+    uint32_t handledFrom = 0xFF00;  // Accesses from here up take the slow path
+    IoHandler io[256];
+};
+
 #endif // MEMORY_H
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "Observation.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+static constexpr int SOURCE_WIDTH = 160;
+static constexpr int SOURCE_HEIGHT = 144;
+
+size_t ObservationWriter::bufferBytes(const ObservationSpec& spec) {
+    return static_cast<size_t>(spec.width) * spec.height * spec.stack;
+}
+
+bool ObservationWriter::configure(const ObservationSpec& spec, uint8_t* buffer) {
+    if (!buffer || spec.width < 1 || spec.width > SOURCE_WIDTH || spec.height < 1 ||
+        spec.height > SOURCE_HEIGHT || spec.stack < 1) {
+        std::cerr << "ObservationWriter::configure failed: need a buffer, 1-160 x 1-144 pixels and stack >= 1"
+                  << std::endl;
+        return false;
+    }
+    current = spec;
+    out = buffer;
+    planeBytes = static_cast<size_t>(spec.width) * spec.height;
+    memset(out, 0, bufferBytes(spec));
+
+    static const uint8_t luminance[4] = {255, 170, 85, 0};
+    for (int s = 0; s < 4; s++)
+        values[s] = spec.format == ObservationSpec::LUMINANCE ? luminance[s] : static_cast<uint8_t>(s);
+
+    // Each source pixel goes to the destination pixel containing its center
+    int columnPixels[SOURCE_WIDTH] = {};
+    int columnStart[SOURCE_WIDTH] = {};
+    for (int x = SOURCE_WIDTH - 1; x >= 0; x--) {
+        column[x] = static_cast<uint8_t>((2 * x + 1) * spec.width / (2 * SOURCE_WIDTH));
+        columnPixels[column[x]]++;
+        columnStart[column[x]] = x;
+    }
+    maxRun = *std::max_element(columnPixels, columnPixels + spec.width);
+    for (int k = 0; k < maxRun; k++)
+        for (int c = 0; c < spec.width; c++) {
+            bool inside = k < columnPixels[c];
+            runPixel[k * spec.width + c] = inside ? columnStart[c] + k : 0;
+            runMask[k * spec.width + c] = inside ? 0xFFFF : 0;
+        }
+    memset(rowLines, 0, sizeof(rowLines));
+    for (int y = 0; y < SOURCE_HEIGHT; y++) {
+        row[y] = static_cast<uint8_t>((2 * y + 1) * spec.height / (2 * SOURCE_HEIGHT));
+        rowLines[row[y]]++;
+    }
+    for (int c = 0; c < spec.width; c++)
+        sampleColumn[c] = static_cast<uint8_t>((2 * c + 1) * SOURCE_WIDTH / (2 * spec.width));
+    for (int r = 0; r < spec.height; r++)
+        sampleLine[r] = static_cast<uint8_t>((2 * r + 1) * SOURCE_HEIGHT / (2 * spec.height));
+
+    // Rows cover either the shortest height or one line more
+    shortestRow = *std::min_element(rowLines, rowLines + spec.height);
+    for (int tall = 0; tall < 2; tall++)
+        for (int c = 0; c < spec.width; c++) {
+            uint32_t pixels = static_cast<uint32_t>(columnPixels[c] * (shortestRow + tall));
+            reciprocal[tall][c] = pixels ? ((1u << 24) + pixels / 2) / pixels : 0;
+        }
+    memset(columnSums, 0, sizeof(columnSums));
+    return true;
+}
+
+void ObservationWriter::clear() {
+    out = nullptr;
+}
+
+void ObservationWriter::beginFrame() {
+    if (out && current.stack > 1)
+        memmove(out, out + planeBytes, planeBytes * (current.stack - 1));
+}
+
+void ObservationWriter::addLine(int line, const uint8_t* pixels) {
+    if (!out || line < 0 || line >= SOURCE_HEIGHT)
+        return;
+    if (current.format == ObservationSpec::LUMINANCE)
+        boxLine(line, pixels);
+    else
+        nearestLine(line, pixels);
+}
+
+void ObservationWriter::nearestLine(int line, const uint8_t* pixels) {
+    int r = row[line];
+    if (sampleLine[r] != line)
+        return;
+    uint8_t* dest = out + planeBytes * (current.stack - 1) + r * current.width;
+    int c = 0;
+#if defined(__SSSE3__)
+    if (current.width == SOURCE_WIDTH / 2) {
+        // Odd source columns (the centers of 2:1 pairs), 16 outputs per step
+        const __m128i odd = _mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15, -1, -1, -1, -1, -1, -1, -1, -1);
+        for (; c + 16 <= current.width; c += 16) {
+            __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 2 * c)), odd);
+            __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 2 * c + 16)), odd);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + c), _mm_unpacklo_epi64(a, b));
+        }
+    }
+#endif
+    for (; c < current.width; c++)
+        dest[c] = pixels[sampleColumn[c]];
+}
+
+void ObservationWriter::boxLine(int line, const uint8_t* pixels) {
+    // Sum vertically on every line, horizontally once per destination row
+    int x = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= SOURCE_WIDTH; x += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + x));
+        __m128i* sums = reinterpret_cast<__m128i*>(columnSums + x);
+        _mm_storeu_si128(sums, _mm_add_epi16(_mm_loadu_si128(sums), _mm_unpacklo_epi8(bytes, zero)));
+        _mm_storeu_si128(sums + 1, _mm_add_epi16(_mm_loadu_si128(sums + 1), _mm_unpackhi_epi8(bytes, zero)));
+    }
+#endif
+    for (; x < SOURCE_WIDTH; x++)
+        columnSums[x] = static_cast<uint16_t>(columnSums[x] + pixels[x]);
+
+    int r = row[line];
+    if (line + 1 < SOURCE_HEIGHT && row[line + 1] == r)
+        return;
+
+    const int width = current.width;
+    uint32_t totals[SOURCE_WIDTH];
+    int c = 0;
+#if defined(__SSE2__)
+    if (width == SOURCE_WIDTH / 2) {
+        // Adjacent 16-bit column sums added as 32-bit lanes, 4 outputs per step
+        const __m128i low = _mm_set1_epi32(0xFFFF);
+        for (; c + 4 <= width; c += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columnSums + 2 * c));
+            __m128i pairs = _mm_add_epi32(_mm_and_si128(v, low), _mm_srli_epi32(v, 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(totals + c), pairs);
+        }
+    }
+#endif
+    // Destination columns cover up to `maxRun` source columns; masking the
+    // shorter runs keeps the loops free of data-dependent branches
+#if defined(__AVX2__)
+    for (; c + 8 <= width; c += 8) {
+        __m256i total = _mm256_setzero_si256();
+        for (int k = 0; k < maxRun; k++) {
+            __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(runPixel + k * width + c));
+            __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(runMask + k * width + c));
+            __m256i sums = _mm256_i32gather_epi32(reinterpret_cast<const int*>(columnSums), index, 2);
+            total = _mm256_add_epi32(total, _mm256_and_si256(sums, mask));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(totals + c), total);
+    }
+#endif
+    for (; c < width; c++) {
+        uint32_t total = 0;
+        for (int k = 0; k < maxRun; k++)
+            total += columnSums[runPixel[k * width + c]] & runMask[k * width + c];
+        totals[c] = total;
+    }
+
+    const uint32_t* scale = reciprocal[rowLines[r] - shortestRow];
+    uint8_t* dest = out + planeBytes * (current.stack - 1) + r * width;
+    c = 0;
+#if defined(__AVX2__)
+    const __m256i half = _mm256_set1_epi32(1 << 23);
+    for (; c + 8 <= width; c += 8) {
+        __m256i total = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(totals + c));
+        __m256i factor = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(scale + c));
+        __m256i value = _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi32(total, factor), half), 24);
+        __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + c), _mm_packus_epi16(words, words));
+    }
+#endif
+    // The product stays below 2^32: totals <= 255 * pixels and scale ~ 2^24 / pixels
+    for (; c < width; c++)
+        dest[c] = static_cast<uint8_t>((totals[c] * scale[c] + (1u << 23)) >> 24);
+    memset(columnSums, 0, sizeof(columnSums));
+}
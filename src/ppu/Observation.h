@@ -0,0 +1,66 @@
+#ifndef OBSERVATION_H
+#define OBSERVATION_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Reduced-resolution frames for agents, written straight from scanline output
+// into a caller-owned buffer (no full-size frame buffer in between).
+struct ObservationSpec {
+    enum Format : uint8_t {
+        SHADE_INDEX,   // Shade 0-3 of the nearest source pixel
+        LUMINANCE      // 0-255 gray (255 = white), averaged over the covered pixels
+    };
+
+    int width = 84;    // 1-160
+    int height = 84;   // 1-144
+    Format format = LUMINANCE;
+    int stack = 1;     // Frames kept in the buffer, oldest first
+};
+
+// Downscales the visible lines of each frame into `stack` planes of
+// width x height bytes. Every source pixel belongs to the destination pixel
+// its center falls in, so exact factors (80x72, 40x36) are plain box filters.
+class ObservationWriter {
+public:
+    // Validate `spec` and start writing into `buffer` (bufferBytes(spec) bytes)
+    bool configure(const ObservationSpec& spec, uint8_t* buffer);
+    void clear();
+
+    bool active() const { return out != nullptr; }
+    const ObservationSpec& spec() const { return current; }
+    static size_t bufferBytes(const ObservationSpec& spec);
+
+    // Value the PPU should emit for each shade (applied with the palette)
+    const uint8_t* shadeValues() const { return values; }
+
+    // Drop the oldest stacked frame to make room for a new one
+    void beginFrame();
+
+    // Consume visible line `line` (160 values from shadeValues())
+    void addLine(int line, const uint8_t* pixels);
+
+private:
+    void boxLine(int line, const uint8_t* pixels);
+    void nearestLine(int line, const uint8_t* pixels);
+
+    ObservationSpec current;
+    uint8_t* out = nullptr;
+    size_t planeBytes = 0;
+
+    uint8_t values[4] = {};
+    uint8_t column[160] = {};      // Destination column of each source column
+    int maxRun = 0;                // Most source columns in one destination column
+    int32_t runPixel[2 * 160] = {}; // Box: k-th source column of each destination column
+    uint32_t runMask[2 * 160] = {}; // Box: 0xFFFF where that k-th column exists
+    uint8_t row[144] = {};         // Destination row of each source line
+    uint8_t sampleColumn[160] = {}; // Nearest: source column of each destination column
+    uint8_t sampleLine[144] = {};  // Nearest: source line of each destination row
+    uint8_t rowLines[144] = {};    // Box: source lines per destination row
+    int shortestRow = 0;
+    uint32_t reciprocal[2][160] = {}; // Box: 2^24 / covered pixels, for the two row heights
+    uint16_t columnSums[160 + 2] = {}; // Box: source columns summed over the current row's lines
+                                       // (padded for 32-bit gathers)
+};
+
+#endif // OBSERVATION_H
@@ -0,0 +1,313 @@
+#include "PPU.h"
+#include <algorithm>
+#include <cstring>
+#include "TileDecode.h"
+
+// LCD registers
+static constexpr uint16_t REG_IF = 0xFF0F;
+static constexpr uint16_t REG_LCDC = 0xFF40;
+static constexpr uint16_t REG_STAT = 0xFF41;
+static constexpr uint16_t REG_SCY = 0xFF42;
+static constexpr uint16_t REG_SCX = 0xFF43;
+static constexpr uint16_t REG_LY = 0xFF44;
+static constexpr uint16_t REG_LYC = 0xFF45;
+static constexpr uint16_t REG_BGP = 0xFF47;
+static constexpr uint16_t REG_OBP0 = 0xFF48;
+static constexpr uint16_t REG_OBP1 = 0xFF49;
+static constexpr uint16_t REG_WY = 0xFF4A;
+static constexpr uint16_t REG_WX = 0xFF4B;
+static constexpr uint16_t OAM_START = 0xFE00;
+
+// Mode 2 and mode 3 end at these cycles of a visible line
+static constexpr uint32_t OAM_CYCLES = 80;
+static constexpr uint32_t TRANSFER_END = 80 + 172;
+
+static constexpr int MAX_SPRITES_PER_LINE = 10;
+
+PPU::PPU(Memory* mem) : memory(mem) {
+    reset();
+}
+
+void PPU::attach(SyncHook sync, void* context) {
+    syncHook = sync;
+    syncContext = context;
+    memory->setIoHandler(REG_STAT, nullptr, writeRegister, this);
+    memory->setIoHandler(REG_LYC, nullptr, writeRegister, this);
+}
+
+// STAT bits 0-2 belong to the PPU; either write can start or end a STAT
+// interrupt condition right away
+void PPU::writeRegister(void* context, uint16_t address, uint8_t value) {
+    PPU* ppu = static_cast<PPU*>(context);
+    if (ppu->syncHook)
+        ppu->syncHook(ppu->syncContext);
+    Memory* memory = ppu->memory;
+    if (address == REG_STAT)
+        value = static_cast<uint8_t>((value & 0x78) | (memory->raw()[REG_STAT] & 0x07));
+    memory->poke(address, value);
+    ppu->updateStat();
+}
+
+void PPU::reset() {
+    lineCycles = 0;
+    ly = 0;
+    mode = MODE_OAM;
+    windowLine = 0;
+    lcdOn = false;
+    statLine = false;
+    frames = 0;
+    skipped = frameSkip;  // The first frame is drawn
+    rendering = true;
+    lastFrameRendered = false;
+    memset(frame, 0, sizeof(frame));
+}
+
+void PPU::setFrameSkip(uint32_t skip) {
+    frameSkip = skip;
+    skipped = skip;
+}
+
+bool PPU::setObservation(const ObservationSpec& spec, uint8_t* buffer) {
+    return observation.configure(spec, buffer);
+}
+
+// Decide at line 0 whether this frame is drawn
+void PPU::beginFrame() {
+    windowLine = 0;
+    if (frameRequested || (frameSkip != RENDER_OFF && skipped >= frameSkip)) {
+        rendering = true;
+        frameRequested = false;
+        skipped = 0;
+        observation.beginFrame();
+    } else {
+        rendering = false;
+        skipped++;
+    }
+}
+
+// Whether the window covers part of visible line `line`
+bool PPU::windowOnLine(int line) const {
+    const uint8_t* mem = memory->raw();
+    return (mem[REG_LCDC] & 0x21) == 0x21 && line >= mem[REG_WY] && mem[REG_WX] < SCREEN_WIDTH + 7;
+}
+
+PPUState PPU::saveState() const {
+    PPUState state;
+    state.lineCycles = lineCycles;
+    state.ly = ly;
+    state.mode = mode;
+    state.windowLine = windowLine;
+    state.lcdOn = lcdOn;
+    state.statLine = statLine;
+    state.frames = frames;
+    return state;
+}
+
+void PPU::loadState(const PPUState& state) {
+    lineCycles = state.lineCycles;
+    ly = state.ly;
+    mode = state.mode;
+    windowLine = state.windowLine;
+    lcdOn = state.lcdOn;
+    statLine = state.statLine;
+    frames = state.frames;
+}
+
+void PPU::setLY(uint8_t line) {
+    ly = line;
+    memory->writeByte(REG_LY, line);
+}
+
+void PPU::requestInterrupt(uint8_t bit) {
+    memory->writeByte(REG_IF, memory->readByte(REG_IF) | static_cast<uint8_t>(1 << bit));
+}
+
+// Refresh the STAT mode/coincidence bits and raise the LCD STAT interrupt on
+// a rising edge of any enabled source
+void PPU::updateStat() {
+    const uint8_t* mem = memory->raw();
+    bool coincidence = ly == mem[REG_LYC];
+    uint8_t stat = static_cast<uint8_t>(0x80 | (mem[REG_STAT] & 0x78) | (coincidence ? 0x04 : 0) | mode);
+    memory->poke(REG_STAT, stat);
+
+    bool signal = (coincidence && (stat & 0x40)) ||
+                  (mode == MODE_HBLANK && (stat & 0x08)) ||
+                  (mode == MODE_VBLANK && (stat & 0x10)) ||
+                  (mode == MODE_OAM && (stat & 0x20));
+    if (signal && !statLine)
+        requestInterrupt(1);
+    statLine = signal;
+}
+
+void PPU::step(uint32_t cycles) {
+    const uint8_t* mem = memory->raw();
+
+    if (!(mem[REG_LCDC] & 0x80)) {
+        // LCD off: LY stays at 0 and nothing is drawn
+        if (lcdOn) {
+            lcdOn = false;
+            lineCycles = 0;
+            mode = MODE_HBLANK;
+            windowLine = 0;
+            setLY(0);
+            updateStat();
+        }
+        return;
+    }
+    if (!lcdOn) {
+        lcdOn = true;
+        lineCycles = 0;
+        mode = MODE_OAM;
+        beginFrame();
+        setLY(0);
+        updateStat();
+    }
+
+    lineCycles += cycles;
+    for (;;) {
+        if (mode == MODE_OAM && lineCycles >= OAM_CYCLES) {
+            mode = MODE_TRANSFER;
+            updateStat();
+        } else if (mode == MODE_TRANSFER && lineCycles >= TRANSFER_END) {
+            if (rendering)
+                renderScanline(ly);
+            else if (windowOnLine(ly))
+                windowLine++;  // Keep the window counter exact for saved states
+            mode = MODE_HBLANK;
+            updateStat();
+        } else if (lineCycles >= CYCLES_PER_LINE) {
+            lineCycles -= CYCLES_PER_LINE;
+            uint8_t next = static_cast<uint8_t>(ly + 1);
+            if (next == SCREEN_HEIGHT) {
+                mode = MODE_VBLANK;
+                frames++;
+                lastFrameRendered = rendering;
+                requestInterrupt(0);
+            } else if (next == LINES_PER_FRAME) {
+                next = 0;
+                mode = MODE_OAM;
+                beginFrame();
+            } else if (next < SCREEN_HEIGHT) {
+                mode = MODE_OAM;
+            }
+            setLY(next);
+            updateStat();
+        } else {
+            break;
+        }
+    }
+}
+
+uint32_t PPU::cyclesUntilEvent() const {
+    // While the LCD is off nothing changes; look again a line later
+    if (!lcdOn)
+        return CYCLES_PER_LINE;
+    if (mode == MODE_OAM)
+        return OAM_CYCLES - lineCycles;
+    if (mode == MODE_TRANSFER)
+        return TRANSFER_END - lineCycles;
+    return CYCLES_PER_LINE - lineCycles;
+}
+
+void PPU::renderScanline(int line) {
+    const uint8_t* mem = memory->raw();
+    const uint8_t lcdc = mem[REG_LCDC];
+
+    // Pick up tiles written since the last line (usually none)
+    tiles.update(memory);
+
+    // Color index per pixel: 0-3 background/window, 4-7 OBP0, 8-11 OBP1.
+    // Rows are copied 8 pixels at a time into 21 tiles' worth of space.
+    alignas(32) uint8_t indices[SCREEN_WIDTH + 16];
+    alignas(32) uint8_t row8[21 * 8];
+
+    // Decoded row `row` of tile `tileIndex` (LCDC bit 4 selects the addressing mode)
+    auto tileRow = [&](uint8_t tileIndex, int row) -> uint64_t {
+        int tile = (lcdc & 0x10) ? tileIndex : 256 + static_cast<int8_t>(tileIndex);
+        return tiles.row(tile, row);
+    };
+
+    if (lcdc & 0x01) {
+        // Background: 21 tiles cover 160 pixels at any fine scroll
+        uint8_t scx = mem[REG_SCX];
+        uint8_t y = static_cast<uint8_t>(mem[REG_SCY] + line);
+        const uint8_t* map = mem + ((lcdc & 0x08) ? 0x9C00 : 0x9800) + (y >> 3) * 32;
+        for (int t = 0; t < 21; t++)
+            tile::store8(row8 + t * 8, tileRow(map[((scx >> 3) + t) & 31], y & 7));
+        memcpy(indices, row8 + (scx & 7), SCREEN_WIDTH);
+
+        // Window, drawn from its own line counter
+        int wx = mem[REG_WX] - 7;
+        if (windowOnLine(line)) {
+            const uint8_t* windowMap = mem + ((lcdc & 0x40) ? 0x9C00 : 0x9800) + (windowLine >> 3) * 32;
+            int start = std::max(wx, 0);
+            int count = (SCREEN_WIDTH - wx + 7) / 8;
+            for (int t = 0; t < count; t++)
+                tile::store8(row8 + t * 8, tileRow(windowMap[t], windowLine & 7));
+            memcpy(indices + start, row8 + (start - wx), SCREEN_WIDTH - start);
+            windowLine++;
+        }
+    } else {
+        memset(indices, 0, SCREEN_WIDTH);
+    }
+
+    if (lcdc & 0x02) {
+        // Sprites: the first 10 in OAM order on this line, lower X winning overlaps
+        const uint8_t* oam = mem + OAM_START;
+        int height = (lcdc & 0x04) ? 16 : 8;
+        uint8_t selected[MAX_SPRITES_PER_LINE];
+        int count = 0;
+        for (int i = 0; i < 40 && count < MAX_SPRITES_PER_LINE; i++) {
+            int top = oam[i * 4] - 16;
+            if (line >= top && line < top + height)
+                selected[count++] = static_cast<uint8_t>(i);
+        }
+        std::stable_sort(selected, selected + count, [&](uint8_t a, uint8_t b) {
+            return oam[a * 4 + 1] < oam[b * 4 + 1];
+        });
+
+        bool claimed[SCREEN_WIDTH] = {};
+        for (int s = 0; s < count; s++) {
+            const uint8_t* sprite = oam + selected[s] * 4;
+            uint8_t attributes = sprite[3];
+            int row = line - (sprite[0] - 16);
+            if (attributes & 0x40)
+                row = height - 1 - row;
+            uint8_t tileIndex = height == 16 ? (sprite[2] & 0xFE) : sprite[2];
+            uint64_t decoded = tiles.row(tileIndex + (row >> 3), row & 7);
+
+            uint8_t pixels[8];
+            tile::store8(pixels, (attributes & 0x20) ? tile::flipRow(decoded) : decoded);
+            uint8_t palette = (attributes & 0x10) ? 8 : 4;
+            bool behind = attributes & 0x80;
+            int x0 = sprite[1] - 8;
+            for (int i = 0; i < 8; i++) {
+                int x = x0 + i;
+                if (x < 0 || x >= SCREEN_WIDTH || claimed[x] || !pixels[i])
+                    continue;
+                // A higher-priority sprite hides lower ones even where the background wins
+                claimed[x] = true;
+                if (!behind || indices[x] == 0)
+                    indices[x] = static_cast<uint8_t>(palette + pixels[i]);
+            }
+        }
+    }
+
+    // Index -> shade through BGP/OBP0/OBP1 in one table. Observations fold
+    // their shade -> value mapping into the same lookup.
+    static const uint8_t identity[4] = {0, 1, 2, 3};
+    const uint8_t* values = observation.active() ? observation.shadeValues() : identity;
+    alignas(16) uint8_t shades[16] = {};
+    const uint8_t palettes[3] = {mem[REG_BGP], mem[REG_OBP0], mem[REG_OBP1]};
+    for (int p = 0; p < 3; p++)
+        for (int i = 0; i < 4; i++)
+            shades[p * 4 + i] = values[(palettes[p] >> (i * 2)) & 3];
+
+    if (observation.active()) {
+        alignas(32) uint8_t pixels[SCREEN_WIDTH];
+        tile::applyPalette(indices, pixels, SCREEN_WIDTH, shades);
+        observation.addLine(line, pixels);
+    } else {
+        tile::applyPalette(indices, frame + line * SCREEN_WIDTH, SCREEN_WIDTH, shades);
+    }
+}
@@ -0,0 +1,117 @@
+#ifndef PPU_H
+#define PPU_H
+
+#include <cstdint>
+#include "memory/Memory.h"
+#include "Observation.h"
+#include "TileCache.h"
+
+// PPU state outside memory (save states)
+struct PPUState {
+    uint32_t lineCycles;
+    uint8_t ly;
+    uint8_t mode;
+    uint8_t windowLine;
+    bool lcdOn;
+    bool statLine;
+    uint64_t frames;
+};
+
+// Scanline PPU. Registers, VRAM and OAM live in Memory; the PPU advances its
+// mode state machine by CPU cycles, updates LY/STAT/IF and renders each
+// visible line in one pass when the line enters HBlank from pre-decoded tiles. The frame buffer holds
+// shades 0 (white) to 3 (black).
+class PPU {
+public:
+    static constexpr int SCREEN_WIDTH = 160;
+    static constexpr int SCREEN_HEIGHT = 144;
+    static constexpr uint32_t CYCLES_PER_LINE = 456;
+    static constexpr int LINES_PER_FRAME = 154;
+
+    // PPU modes as reported in STAT bits 0-1
+    enum Mode : uint8_t {
+        MODE_HBLANK = 0,
+        MODE_VBLANK = 1,
+        MODE_OAM = 2,
+        MODE_TRANSFER = 3
+    };
+
+    // setFrameSkip() value for a PPU that never renders unless asked to
+    static constexpr uint32_t RENDER_OFF = UINT32_MAX;
+
+    explicit PPU(Memory* mem);
+
+    // Install the STAT/LYC write handlers in memory. Writes call `sync` first
+    // so the owner can bring the PPU up to the current cycle.
+    using SyncHook = void (*)(void* context);
+    void attach(SyncHook sync, void* context);
+
+    void reset();
+
+    // Advance by `cycles` CPU clock cycles
+    void step(uint32_t cycles);
+
+    // Cycles until the next mode change (what a scheduler should wait for)
+    uint32_t cyclesUntilEvent() const;
+
+    // Render visible line `line` from the current registers and VRAM
+    void renderScanline(int line);
+
+    // Headless frame skipping. Timing, LY/STAT and interrupts run the same
+    // either way; only pixel generation is skipped. After a rendered frame the
+    // next `skip` frames are skipped (0 renders every frame, RENDER_OFF
+    // never does). requestFrame() renders the next frame regardless.
+    void setFrameSkip(uint32_t skip);
+    uint32_t getFrameSkip() const { return frameSkip; }
+    void requestFrame() { frameRequested = true; }
+
+    // Whether the frame buffer holds the most recently completed frame
+    bool frameRendered() const { return lastFrameRendered; }
+
+    // Write rendered frames downscaled into `buffer` (ObservationWriter::
+    // bufferBytes(spec) bytes) instead of the frame buffer, which is then
+    // left untouched. Frame skipping applies to observations too.
+    bool setObservation(const ObservationSpec& spec, uint8_t* buffer);
+    void clearObservation() { observation.clear(); }
+
+    const uint8_t* frameBuffer() const { return frame; }
+    uint64_t getFrames() const { return frames; }
+    const TileCache& tileCache() const { return tiles; }
+
+    PPUState saveState() const;
+    void loadState(const PPUState& state);
+
+private:
+    static void writeRegister(void* context, uint16_t address, uint8_t value);
+
+    void beginFrame();
+    bool windowOnLine(int line) const;
+    void setLY(uint8_t line);
+    void updateStat();
+    void requestInterrupt(uint8_t bit);
+
+    Memory* memory;
+    SyncHook syncHook = nullptr;
+    void* syncContext = nullptr;
+
+    uint32_t lineCycles = 0;
+    uint8_t ly = 0;
+    uint8_t mode = MODE_OAM;
+    uint8_t windowLine = 0;    // Window rows drawn this frame
+    bool lcdOn = false;
+    bool statLine = false;     // Combined STAT interrupt signal (interrupts on its rising edge)
+    uint64_t frames = 0;
+
+    // Frame skipping (client settings, not saved state)
+    uint32_t frameSkip = 0;
+    uint32_t skipped = 0;          // Frames skipped since the last rendered one
+    bool frameRequested = false;
+    bool rendering = true;         // Whether the current frame is being drawn
+    bool lastFrameRendered = false;
+
+    TileCache tiles;           // Derived from VRAM, not part of the saved state
+    ObservationWriter observation;
+    uint8_t frame[SCREEN_WIDTH * SCREEN_HEIGHT];
+};
+
+#endif // PPU_H
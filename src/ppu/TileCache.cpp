@@ -0,0 +1,22 @@
+#include "TileCache.h"
+#include "TileDecode.h"
+
+void TileCache::update(Memory* memory) {
+    uint64_t* dirty = memory->dirtyTiles();
+    const uint8_t* vram = memory->raw() + 0x8000;
+
+    for (int w = 0; w < Memory::DIRTY_WORDS; w++) {
+        uint64_t bits = dirty[w];
+        if (!bits)
+            continue;
+        dirty[w] = 0;
+        while (bits) {
+            int tile = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            const uint8_t* data = vram + tile * 16;
+            for (int y = 0; y < 8; y++)
+                rows[tile][y] = tile::decodeTileRow(data[y * 2], data[y * 2 + 1]);
+            decoded++;
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <cstdint>
+#include "memory/Memory.h"
+
+// All 384 VRAM tiles decoded to color indices, one packed uint64_t per row
+// (see tile::decodeTileRow). Memory::writeByte marks the tiles it touches and
+// update() decodes just those, so frames that leave tile data alone do no
+// bit-plane work at all.
+class TileCache {
+public:
+    static constexpr int TILE_COUNT = Memory::VRAM_TILES;
+
+    // Decode the tiles written since the last update
+    void update(Memory* memory);
+
+    // Row `y` of tile `tile` (0-383, tile 0 at 0x8000)
+    uint64_t row(int tile, int y) const { return rows[tile][y]; }
+
+    // Tiles decoded so far (cache effectiveness)
+    uint64_t decodedTiles() const { return decoded; }
+
+private:
+    uint64_t rows[TILE_COUNT][8] = {};
+    uint64_t decoded = 0;
+};
+
+#endif // TILECACHE_H
@@ -0,0 +1,181 @@
+#include "PerfCounters.h"
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char* PHASE_NAMES[PERF_PHASES] = {"cpu", "ppu", "trace"};
+
+PerfCounters::~PerfCounters() {
+    close();
+}
+
+#ifdef __linux__
+
+static int openEvent(uint32_t type, uint64_t config, int groupFd) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = groupFd < 0;  // The group starts with the leader
+    attr.exclude_kernel = 1;      // Allowed with perf_event_paranoid <= 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+}
+
+static uint64_t cacheMiss(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+bool PerfCounters::open() {
+    close();
+
+    const struct { uint32_t type; uint64_t config; } events[PERF_EVENTS] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D)},
+        {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL)},
+    };
+
+    for (int i = 0; i < PERF_EVENTS; i++) {
+        fds[i] = openEvent(events[i].type, events[i].config, leader);
+        if (fds[i] < 0)
+            continue;
+        if (leader < 0)
+            leader = fds[i];
+        slot[i] = opened++;
+    }
+
+    if (leader < 0) {
+        if (errno == ENOENT || errno == EOPNOTSUPP)
+            std::cerr << "PerfCounters::open failed: no hardware counters on this host (virtual machine?)"
+                      << std::endl;
+        else
+            std::cerr << "PerfCounters::open failed: " << strerror(errno)
+                      << " (check /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+        return false;
+    }
+
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+void PerfCounters::close() {
+    for (int& fd : fds) {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+    leader = -1;
+    opened = 0;
+    stack.clear();
+}
+
+bool PerfCounters::read(uint64_t* values) {
+    // PERF_FORMAT_GROUP layout: u64 count, then one u64 per opened event
+    uint64_t buffer[1 + PERF_EVENTS];
+    ssize_t expected = static_cast<ssize_t>((1 + opened) * sizeof(uint64_t));
+    if (::read(leader, buffer, sizeof(buffer)) != expected)
+        return false;
+    for (int i = 0; i < PERF_EVENTS; i++)
+        values[i] = fds[i] >= 0 ? buffer[1 + slot[i]] : 0;
+    return true;
+}
+
+#else
+
+bool PerfCounters::open() {
+    std::cerr << "PerfCounters::open failed: perf_event_open is only available on Linux" << std::endl;
+    return false;
+}
+
+void PerfCounters::close() {
+    stack.clear();
+}
+
+bool PerfCounters::read(uint64_t*) {
+    return false;
+}
+
+#endif
+
+// Add the counts since the last reading to the innermost phase
+void PerfCounters::charge(const uint64_t* now) {
+    if (!stack.empty()) {
+        PerfTotals& totals = phases[static_cast<int>(stack.back())];
+        for (int i = 0; i < PERF_EVENTS; i++)
+            totals.events[i] += now[i] - last[i];
+    }
+    memcpy(last, now, sizeof(last));
+}
+
+void PerfCounters::enter(PerfPhase phase) {
+    uint64_t now[PERF_EVENTS];
+    if (!available() || !read(now))
+        return;
+    charge(now);
+    stack.push_back(phase);
+    phases[static_cast<int>(phase)].entries++;
+}
+
+void PerfCounters::leave(uint64_t emulatedInstructions) {
+    uint64_t now[PERF_EVENTS];
+    if (!available() || stack.empty() || !read(now))
+        return;
+    charge(now);
+    phases[static_cast<int>(stack.back())].emulatedInstructions += emulatedInstructions;
+    stack.pop_back();
+}
+
+void PerfCounters::clear() {
+    for (PerfTotals& totals : phases)
+        totals = PerfTotals();
+}
+
+void PerfCounters::report(std::ostream& out) const {
+    static const char* eventNames[PERF_EVENTS] = {"cycles", "instructions", "branch-miss", "L1d-miss", "LLC-miss"};
+
+    std::ios::fmtflags flags = out.flags();
+    out << std::left << std::setw(8) << "phase";
+    for (int i = 0; i < PERF_EVENTS; i++)
+        out << std::right << std::setw(15) << eventNames[i];
+    out << std::setw(8) << "IPC" << std::setw(14) << "emulated" << std::setw(12) << "host/emu"
+        << std::setw(14) << "bmiss/emu" << std::endl;
+
+    for (int p = 0; p < PERF_PHASES; p++) {
+        const PerfTotals& t = phases[p];
+        if (!t.entries)
+            continue;
+        out << std::left << std::setw(8) << PHASE_NAMES[p] << std::right;
+        for (int i = 0; i < PERF_EVENTS; i++) {
+            if (fds[i] >= 0)
+                out << std::setw(15) << t.events[i];
+            else
+                out << std::setw(15) << "n/a";
+        }
+
+        const uint64_t* e = t.events;
+        double cycles = static_cast<double>(e[static_cast<int>(PerfEvent::Cycles)]);
+        double instructions = static_cast<double>(e[static_cast<int>(PerfEvent::Instructions)]);
+        double misses = static_cast<double>(e[static_cast<int>(PerfEvent::BranchMisses)]);
+        double emulated = static_cast<double>(t.emulatedInstructions);
+        out << std::fixed << std::setprecision(2) << std::setw(8) << (cycles > 0 ? instructions / cycles : 0.0)
+            << std::setw(14) << t.emulatedInstructions;
+        if (emulated > 0)
+            out << std::setw(12) << instructions / emulated << std::setprecision(4) << std::setw(14)
+                << misses / emulated;
+        out << std::endl;
+    }
+    out.flags(flags);
+}
@@ -0,0 +1,102 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+// Host hardware counters (Linux perf_event_open) attributed to emulator phases.
+// Counters are read with a system call, so phases should wrap emulation quanta
+// (thousands of instructions), not single instructions.
+
+// Memory and I/O register accesses happen inside instructions and are
+// counted as Cpu; Ppu covers the PPU catching up at its scheduled events.
+enum class PerfPhase {
+    Cpu,
+    Ppu,
+    Trace,
+    Count
+};
+
+enum class PerfEvent {
+    Cycles,
+    Instructions,
+    BranchMisses,
+    L1dMisses,   // L1 data cache read misses
+    LLCMisses,   // Last-level cache read misses
+    Count
+};
+
+static constexpr int PERF_PHASES = static_cast<int>(PerfPhase::Count);
+static constexpr int PERF_EVENTS = static_cast<int>(PerfEvent::Count);
+
+// Counts accumulated by one phase
+struct PerfTotals {
+    uint64_t events[PERF_EVENTS] = {};
+    uint64_t emulatedInstructions = 0;
+    uint64_t entries = 0;
+};
+
+// Counters of the calling thread, one instance per emulator instance. Phases
+// may nest; time inside an inner phase is not counted for the outer one.
+class PerfCounters {
+public:
+    PerfCounters() = default;
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Open the counters for the calling thread. Events the host does not
+    // support are left out; fails when none can be opened.
+    bool open();
+    void close();
+
+    bool available() const { return leader >= 0; }
+    bool eventAvailable(PerfEvent event) const { return fds[static_cast<int>(event)] >= 0; }
+
+    void enter(PerfPhase phase);
+    void leave(uint64_t emulatedInstructions = 0);
+
+    const PerfTotals& totals(PerfPhase phase) const { return phases[static_cast<int>(phase)]; }
+    void clear();
+
+    // Per-phase table with host IPC and per-emulated-instruction rates
+    void report(std::ostream& out) const;
+
+private:
+    bool read(uint64_t* values);
+    void charge(const uint64_t* now);
+
+    int leader = -1;
+    int fds[PERF_EVENTS] = {-1, -1, -1, -1, -1};
+    int slot[PERF_EVENTS] = {};  // Position of each event in a group read
+    int opened = 0;
+
+    PerfTotals phases[PERF_PHASES];
+    std::vector<PerfPhase> stack;
+    uint64_t last[PERF_EVENTS] = {};
+};
+
+// Counts the enclosed scope as `phase`
+class PerfScope {
+public:
+    PerfScope(PerfCounters* counters, PerfPhase phase) : counters(counters) {
+        if (counters)
+            counters->enter(phase);
+    }
+    ~PerfScope() {
+        if (counters)
+            counters->leave(emulated);
+    }
+
+    // Emulated instructions retired inside the scope
+    void setEmulated(uint64_t instructions) { emulated = instructions; }
+
+private:
+    PerfCounters* counters;
+    uint64_t emulated = 0;
+};
+
+#endif // PERFCOUNTERS_H
@@ -0,0 +1,216 @@
+#include "ProfileReport.h"
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+static const char* OPCODE_NAMES[256] = {
+    "NOP", "LD BC,d16", "LD (BC),A", "INC BC",
+    "INC B", "DEC B", "LD B,d8", "RLCA",
+    "LD (a16),SP", "ADD HL,BC", "LD A,(BC)", "DEC BC",
+    "INC C", "DEC C", "LD C,d8", "RRCA",
+    "STOP", "LD DE,d16", "LD (DE),A", "INC DE",
+    "INC D", "DEC D", "LD D,d8", "RLA",
+    "JR r8", "ADD HL,DE", "LD A,(DE)", "DEC DE",
+    "INC E", "DEC E", "LD E,d8", "RRA",
+    "JR NZ,r8", "LD HL,d16", "LD (HL+),A", "INC HL",
+    "INC H", "DEC H", "LD H,d8", "DAA",
+    "JR Z,r8", "ADD HL,HL", "LD A,(HL+)", "DEC HL",
+    "INC L", "DEC L", "LD L,d8", "CPL",
+    "JR NC,r8", "LD SP,d16", "LD (HL-),A", "INC SP",
+    "INC (HL)", "DEC (HL)", "LD (HL),d8", "SCF",
+    "JR C,r8", "ADD HL,SP", "LD A,(HL-)", "DEC SP",
+    "INC A", "DEC A", "LD A,d8", "CCF",
+    "LD B,B", "LD B,C", "LD B,D", "LD B,E",
+    "LD B,H", "LD B,L", "LD B,(HL)", "LD B,A",
+    "LD C,B", "LD C,C", "LD C,D", "LD C,E",
+    "LD C,H", "LD C,L", "LD C,(HL)", "LD C,A",
+    "LD D,B", "LD D,C", "LD D,D", "LD D,E",
+    "LD D,H", "LD D,L", "LD D,(HL)", "LD D,A",
+    "LD E,B", "LD E,C", "LD E,D", "LD E,E",
+    "LD E,H", "LD E,L", "LD E,(HL)", "LD E,A",
+    "LD H,B", "LD H,C", "LD H,D", "LD H,E",
+    "LD H,H", "LD H,L", "LD H,(HL)", "LD H,A",
+    "LD L,B", "LD L,C", "LD L,D", "LD L,E",
+    "LD L,H", "LD L,L", "LD L,(HL)", "LD L,A",
+    "LD (HL),B", "LD (HL),C", "LD (HL),D", "LD (HL),E",
+    "LD (HL),H", "LD (HL),L", "HALT", "LD (HL),A",
+    "LD A,B", "LD A,C", "LD A,D", "LD A,E",
+    "LD A,H", "LD A,L", "LD A,(HL)", "LD A,A",
+    "ADD A,B", "ADD A,C", "ADD A,D", "ADD A,E",
+    "ADD A,H", "ADD A,L", "ADD A,(HL)", "ADD A,A",
+    "ADC A,B", "ADC A,C", "ADC A,D", "ADC A,E",
+    "ADC A,H", "ADC A,L", "ADC A,(HL)", "ADC A,A",
+    "SUB B", "SUB C", "SUB D", "SUB E",
+    "SUB H", "SUB L", "SUB (HL)", "SUB A",
+    "SBC A,B", "SBC A,C", "SBC A,D", "SBC A,E",
+    "SBC A,H", "SBC A,L", "SBC A,(HL)", "SBC A,A",
+    "AND B", "AND C", "AND D", "AND E",
+    "AND H", "AND L", "AND (HL)", "AND A",
+    "XOR B", "XOR C", "XOR D", "XOR E",
+    "XOR H", "XOR L", "XOR (HL)", "XOR A",
+    "OR B", "OR C", "OR D", "OR E",
+    "OR H", "OR L", "OR (HL)", "OR A",
+    "CP B", "CP C", "CP D", "CP E",
+    "CP H", "CP L", "CP (HL)", "CP A",
+    "RET NZ", "POP BC", "JP NZ,a16", "JP a16",
+    "CALL NZ,a16", "PUSH BC", "ADD A,d8", "RST 00H",
+    "RET Z", "RET", "JP Z,a16", "PREFIX CB",
+    "CALL Z,a16", "CALL a16", "ADC A,d8", "RST 08H",
+    "RET NC", "POP DE", "JP NC,a16", "ILLEGAL",
+    "CALL NC,a16", "PUSH DE", "SUB d8", "RST 10H",
+    "RET C", "RETI", "JP C,a16", "ILLEGAL",
+    "CALL C,a16", "ILLEGAL", "SBC A,d8", "RST 18H",
+    "LDH (a8),A", "POP HL", "LD (C),A", "ILLEGAL",
+    "ILLEGAL", "PUSH HL", "AND d8", "RST 20H",
+    "ADD SP,r8", "JP (HL)", "LD (a16),A", "ILLEGAL",
+    "ILLEGAL", "ILLEGAL", "XOR d8", "RST 28H",
+    "LDH A,(a8)", "POP AF", "LD A,(C)", "DI",
+    "ILLEGAL", "PUSH AF", "OR d8", "RST 30H",
+    "LD HL,SP+r8", "LD SP,HL", "LD A,(a16)", "EI",
+    "ILLEGAL", "ILLEGAL", "CP d8", "RST 38H",
+};
+
+const char* opcodeMnemonic(uint8_t opcode) {
+    return OPCODE_NAMES[opcode];
+}
+
+std::string cbOpcodeMnemonic(uint8_t opcode) {
+    static const char* ops[8] = {"RLC", "RRC", "RL", "RR", "SLA", "SRA", "SWAP", "SRL"};
+    static const char* bitOps[4] = {"", "BIT", "RES", "SET"};
+    static const char* regs[8] = {"B", "C", "D", "E", "H", "L", "(HL)", "A"};
+
+    int group = opcode >> 6;
+    int y = (opcode >> 3) & 7;
+    const char* reg = regs[opcode & 7];
+    if (group == 0)
+        return std::string(ops[y]) + " " + reg;
+    return std::string(bitOps[group]) + " " + std::to_string(y) + "," + reg;
+}
+
+namespace {
+
+struct Row {
+    uint32_t key;
+    uint64_t count;
+    uint64_t cycles;
+};
+
+// Rows with a non-zero count, most cycles first
+std::vector<Row> sortedRows(const uint64_t* count, const uint64_t* cycles) {
+    std::vector<Row> rows;
+    for (uint32_t i = 0; i < 256; i++)
+        if (count[i])
+            rows.push_back({i, count[i], cycles[i]});
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+        return a.cycles != b.cycles ? a.cycles > b.cycles : a.key < b.key;
+    });
+    return rows;
+}
+
+std::vector<Row> sortedSamples(const ProfileCounters& counters) {
+    std::vector<Row> rows;
+    for (const auto& entry : counters.pcSamples)
+        rows.push_back({entry.first, entry.second, entry.second});
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+        return a.count != b.count ? a.count > b.count : a.key < b.key;
+    });
+    return rows;
+}
+
+uint64_t total(const uint64_t* values) {
+    uint64_t sum = 0;
+    for (int i = 0; i < 256; i++)
+        sum += values[i];
+    return sum;
+}
+
+double percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+void printOpcodeRows(const std::vector<Row>& rows, bool cb, uint64_t totalCycles,
+                     std::ostream& out, size_t top) {
+    out << "  opcode  mnemonic          count          cycles   cycles%" << std::endl;
+    for (size_t i = 0; i < rows.size() && i < top; i++) {
+        const Row& row = rows[i];
+        std::string name = cb ? cbOpcodeMnemonic(static_cast<uint8_t>(row.key))
+                              : opcodeMnemonic(static_cast<uint8_t>(row.key));
+        out << "  " << (cb ? "CB " : "   ") << std::hex << std::uppercase << std::setfill('0')
+            << std::setw(2) << row.key << std::dec << std::setfill(' ')
+            << "  " << std::left << std::setw(12) << name << std::right
+            << std::setw(12) << row.count << std::setw(16) << row.cycles
+            << std::setw(9) << std::fixed << std::setprecision(2)
+            << percent(row.cycles, totalCycles) << "%" << std::endl;
+    }
+}
+
+} // namespace
+
+void printProfileTable(const ProfileCounters& counters, std::ostream& out, size_t top) {
+    std::ios::fmtflags flags = out.flags();
+    char fill = out.fill();
+
+    uint64_t instructions = total(counters.opcodeCount);
+    uint64_t cycles = total(counters.opcodeCycles);
+    out << "Instructions: " << instructions << ", cycles: " << cycles << std::endl;
+
+    out << std::endl << "Opcodes by cycles:" << std::endl;
+    printOpcodeRows(sortedRows(counters.opcodeCount, counters.opcodeCycles), false, cycles, out, top);
+
+    std::vector<Row> cbRows = sortedRows(counters.cbCount, counters.cbCycles);
+    if (!cbRows.empty()) {
+        out << std::endl << "CB opcodes by cycles:" << std::endl;
+        printOpcodeRows(cbRows, true, cycles, out, top);
+    }
+
+    std::vector<Row> samples = sortedSamples(counters);
+    if (!samples.empty()) {
+        out << std::endl << "Hot PCs (" << counters.sampleCount << " samples):" << std::endl;
+        out << "  bank:addr       samples  samples%" << std::endl;
+        for (size_t i = 0; i < samples.size() && i < top; i++) {
+            const Row& row = samples[i];
+            out << "  " << std::hex << std::uppercase << std::setfill('0')
+                << std::setw(3) << (row.key >> 16) << ":" << std::setw(4) << (row.key & 0xFFFF)
+                << std::dec << std::setfill(' ') << std::setw(14) << row.count
+                << std::setw(9) << std::fixed << std::setprecision(2)
+                << percent(row.count, counters.sampleCount) << "%" << std::endl;
+        }
+    }
+
+    out.flags(flags);
+    out.fill(fill);
+}
+
+void writeProfileJSON(const ProfileCounters& counters, std::ostream& out) {
+    auto table = [&](const char* name, const uint64_t* count, const uint64_t* cycles, bool cb) {
+        out << "  \"" << name << "\": [";
+        bool first = true;
+        for (int i = 0; i < 256; i++) {
+            if (!count[i])
+                continue;
+            std::string mnemonic = cb ? cbOpcodeMnemonic(static_cast<uint8_t>(i))
+                                      : opcodeMnemonic(static_cast<uint8_t>(i));
+            out << (first ? "\n" : ",\n") << "    {\"opcode\": " << i << ", \"mnemonic\": \""
+                << mnemonic << "\", \"count\": " << count[i] << ", \"cycles\": " << cycles[i] << "}";
+            first = false;
+        }
+        out << (first ? "]" : "\n  ]");
+    };
+
+    out << "{" << std::endl;
+    out << "  \"instructions\": " << total(counters.opcodeCount) << "," << std::endl;
+    out << "  \"cycles\": " << total(counters.opcodeCycles) << "," << std::endl;
+    table("opcodes", counters.opcodeCount, counters.opcodeCycles, false);
+    out << "," << std::endl;
+    table("cb_opcodes", counters.cbCount, counters.cbCycles, true);
+    out << "," << std::endl;
+
+    out << "  \"pc_samples\": [";
+    std::vector<Row> samples = sortedSamples(counters);
+    for (size_t i = 0; i < samples.size(); i++)
+        out << (i ? ",\n" : "\n") << "    {\"bank\": " << (samples[i].key >> 16) << ", \"pc\": "
+            << (samples[i].key & 0xFFFF) << ", \"samples\": " << samples[i].count << "}";
+    out << (samples.empty() ? "]" : "\n  ]") << std::endl;
+    out << "}" << std::endl;
+}
@@ -0,0 +1,20 @@
+#ifndef PROFILEREPORT_H
+#define PROFILEREPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include "ProfilePolicy.h"
+
+// Mnemonics for report output ("LD A,(HL)", "BIT 7,H")
+const char* opcodeMnemonic(uint8_t opcode);
+std::string cbOpcodeMnemonic(uint8_t opcode);
+
+// Opcode, CB opcode and hot-PC tables sorted by cycles/samples, `top` rows each
+void printProfileTable(const ProfileCounters& counters, std::ostream& out, size_t top = 20);
+
+// Every non-zero counter as JSON
+void writeProfileJSON(const ProfileCounters& counters, std::ostream& out);
+
+#endif // PROFILEREPORT_H
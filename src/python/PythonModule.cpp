@@ -0,0 +1,682 @@
+// gbemu: Python bindings for GameBoy and VecEnv.
+//
+// Frames, memory, registers, trace records and the VecEnv arrays are exported
+// through the buffer protocol as views of the emulator's own storage, so
+// numpy.asarray(gb.memory) and friends copy nothing and always show the
+// current contents. Running methods release the GIL, so instances can be
+// stepped from several Python threads at once (one thread per instance).
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "env/VecEnv.h"
+#include "gameboy/GameBoy.h"
+
+// The register view exposes CPURegisters in place with the RegisterSnapshot layout
+static_assert(sizeof(CPURegisters) == sizeof(RegisterSnapshot) && std::is_standard_layout<CPURegisters>::value,
+              "CPURegisters no longer matches RegisterSnapshot");
+
+static bool parseAudioMode(const char* name, AudioMode& mode) {
+    std::string value = name;
+    if (value == "off")
+        mode = AudioMode::Off;
+    else if (value == "silent")
+        mode = AudioMode::Silent;
+    else if (value == "full")
+        mode = AudioMode::Full;
+    else {
+        PyErr_SetString(PyExc_ValueError, "audio mode must be 'off', 'silent' or 'full'");
+        return false;
+    }
+    return true;
+}
+
+/////////////////////////  View  ////////////////////////////////
+
+// Buffer exporter for a block of storage owned by another Python object,
+// which it keeps alive. Properties hand these out wrapped in a memoryview.
+struct ViewObject {
+    PyObject_HEAD
+    PyObject* owner;
+    void* data;
+    Py_ssize_t itemsize;
+    const char* format;
+    int ndim;
+    Py_ssize_t shape[4];
+    Py_ssize_t strides[4];
+    bool readonly;
+};
+
+static void View_dealloc(ViewObject* self) {
+    Py_XDECREF(self->owner);
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+static int View_getbuffer(ViewObject* self, Py_buffer* view, int flags) {
+    if ((flags & PyBUF_WRITABLE) && self->readonly) {
+        PyErr_SetString(PyExc_BufferError, "view is read-only");
+        view->obj = nullptr;
+        return -1;
+    }
+    Py_ssize_t length = self->itemsize;
+    for (int d = 0; d < self->ndim; d++)
+        length *= self->shape[d];
+
+    view->buf = self->data;
+    view->obj = reinterpret_cast<PyObject*>(self);
+    Py_INCREF(view->obj);
+    view->len = length;
+    view->readonly = self->readonly;
+    view->itemsize = self->itemsize;
+    view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>(self->format) : nullptr;
+    view->ndim = self->ndim;
+    view->shape = (flags & PyBUF_ND) ? self->shape : nullptr;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? self->strides : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = nullptr;
+    return 0;
+}
+
+static PyBufferProcs View_buffer = {reinterpret_cast<getbufferproc>(View_getbuffer), nullptr};
+
+// Type objects are zero-initialized here and filled in by PyInit_gbemu
+static PyTypeObject ViewType{};
+
+// memoryview of `data` (C order, `ndim` dimensions) that keeps `owner` alive
+static PyObject* makeView(PyObject* owner, void* data, const char* format, Py_ssize_t itemsize,
+                          std::initializer_list<Py_ssize_t> shape, bool readonly) {
+    ViewObject* view = PyObject_New(ViewObject, &ViewType);
+    if (!view)
+        return nullptr;
+    Py_INCREF(owner);
+    view->owner = owner;
+    view->data = data;
+    view->itemsize = itemsize;
+    view->format = format;
+    view->ndim = static_cast<int>(shape.size());
+    view->readonly = readonly;
+    int d = 0;
+    for (Py_ssize_t extent : shape)
+        view->shape[d++] = extent;
+    Py_ssize_t stride = itemsize;
+    for (d = view->ndim - 1; d >= 0; d--) {
+        view->strides[d] = stride;
+        stride *= view->shape[d];
+    }
+
+    PyObject* result = PyMemoryView_FromObject(reinterpret_cast<PyObject*>(view));
+    Py_DECREF(view);
+    return result;
+}
+
+/////////////////////////  GameBoy  ////////////////////////////////
+
+struct GameBoyObject {
+    PyObject_HEAD
+    GameBoy* gameboy;
+};
+
+static PyObject* GameBoy_new(PyTypeObject* type, PyObject*, PyObject*) {
+    GameBoyObject* self = reinterpret_cast<GameBoyObject*>(type->tp_alloc(type, 0));
+    if (self)
+        self->gameboy = nullptr;
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static int GameBoy_init(GameBoyObject* self, PyObject* args, PyObject* kwargs) {
+    // Views handed out so far point into the current console
+    if (self->gameboy) {
+        PyErr_SetString(PyExc_RuntimeError, "GameBoy is already initialized");
+        return -1;
+    }
+    static const char* keywords[] = {"rom", "audio", nullptr};
+    const char* rom = nullptr;
+    const char* audio = "full";
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|s", const_cast<char**>(keywords), &rom, &audio))
+        return -1;
+    AudioMode mode;
+    if (!parseAudioMode(audio, mode))
+        return -1;
+
+    auto gameboy = std::make_unique<GameBoy>();
+    if (!gameboy->loadROM(rom)) {
+        PyErr_Format(PyExc_OSError, "failed to load ROM %s", rom);
+        return -1;
+    }
+    gameboy->setAudioMode(mode);
+    self->gameboy = gameboy.release();
+    return 0;
+}
+
+static void GameBoy_dealloc(GameBoyObject* self) {
+    delete self->gameboy;
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+static bool GameBoy_check(GameBoyObject* self) {
+    if (!self->gameboy)
+        PyErr_SetString(PyExc_RuntimeError, "GameBoy is not initialized");
+    return self->gameboy != nullptr;
+}
+
+static PyObject* GameBoy_reset(GameBoyObject* self, PyObject*) {
+    if (!GameBoy_check(self))
+        return nullptr;
+    self->gameboy->reset();
+    Py_RETURN_NONE;
+}
+
+static PyObject* GameBoy_step(GameBoyObject* self, PyObject* args) {
+    int steps = 1;
+    if (!GameBoy_check(self) || !PyArg_ParseTuple(args, "|i", &steps))
+        return nullptr;
+    GameBoy* gameboy = self->gameboy;
+    Py_BEGIN_ALLOW_THREADS
+    for (int i = 0; i < steps; i++)
+        gameboy->step();
+    Py_END_ALLOW_THREADS
+    Py_RETURN_NONE;
+}
+
+static PyObject* GameBoy_run_until(GameBoyObject* self, PyObject* args) {
+    unsigned long long target;
+    if (!GameBoy_check(self) || !PyArg_ParseTuple(args, "K", &target))
+        return nullptr;
+    GameBoy* gameboy = self->gameboy;
+    Py_BEGIN_ALLOW_THREADS
+    gameboy->runUntil(target);
+    Py_END_ALLOW_THREADS
+    Py_RETURN_NONE;
+}
+
+static PyObject* GameBoy_run_frames(GameBoyObject* self, PyObject* args) {
+    int frames = 1;
+    if (!GameBoy_check(self) || !PyArg_ParseTuple(args, "|i", &frames))
+        return nullptr;
+    GameBoy* gameboy = self->gameboy;
+    Py_BEGIN_ALLOW_THREADS
+    for (int i = 0; i < frames; i++)
+        gameboy->runFrame();
+    Py_END_ALLOW_THREADS
+    Py_RETURN_NONE;
+}
+
+static PyObject* GameBoy_set_buttons(GameBoyObject* self, PyObject* args) {
+    unsigned char buttons;
+    if (!GameBoy_check(self) || !PyArg_ParseTuple(args, "b", &buttons))
+        return nullptr;
+    self->gameboy->getJoypad().setButtons(buttons);
+    Py_RETURN_NONE;
+}
+
+static PyObject* GameBoy_queue_inputs(GameBoyObject* self, PyObject* args) {
+    PyObject* sequence;
+    if (!GameBoy_check(self) || !PyArg_ParseTuple(args, "O", &sequence))
+        return nullptr;
+    PyObject* items = PySequence_Fast(sequence, "inputs must be a sequence of (cycle, buttons) pairs");
+    if (!items)
+        return nullptr;
+
+    std::vector<JoypadInput> inputs(static_cast<size_t>(PySequence_Fast_GET_SIZE(items)));
+    for (size_t i = 0; i < inputs.size(); i++) {
+        unsigned long long cycle;
+        unsigned char buttons;
+        if (!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(items, i), "Kb", &cycle, &buttons)) {
+            Py_DECREF(items);
+            return nullptr;
+        }
+        inputs[i].cycle = cycle;
+        inputs[i].buttons = buttons;
+    }
+    Py_DECREF(items);
+
+    if (!self->gameboy->getJoypad().queue(inputs.data(), inputs.size())) {
+        PyErr_SetString(PyExc_ValueError, "input cycles must not decrease");
+        return nullptr;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject* GameBoy_set_audio_mode(GameBoyObject* self, PyObject* args) {
+    const char* name;
+    AudioMode mode;
+    if (!GameBoy_check(self) || !PyArg_ParseTuple(args, "s", &name) || !parseAudioMode(name, mode))
+        return nullptr;
+    self->gameboy->setAudioMode(mode);
+    Py_RETURN_NONE;
+}
+
+static PyObject* GameBoy_set_frame_skip(GameBoyObject* self, PyObject* args) {
+    PyObject* value;
+    if (!GameBoy_check(self) || !PyArg_ParseTuple(args, "O", &value))
+        return nullptr;
+    uint32_t skip = PPU::RENDER_OFF;
+    if (value != Py_None) {
+        unsigned long frames = PyLong_AsUnsignedLong(value);
+        if (PyErr_Occurred())
+            return nullptr;
+        skip = static_cast<uint32_t>(frames);
+    }
+    self->gameboy->getPPU().setFrameSkip(skip);
+    Py_RETURN_NONE;
+}
+
+static PyObject* GameBoy_request_frame(GameBoyObject* self, PyObject*) {
+    if (!GameBoy_check(self))
+        return nullptr;
+    self->gameboy->getPPU().requestFrame();
+    Py_RETURN_NONE;
+}
+
+static PyObject* GameBoy_clear_trace(GameBoyObject* self, PyObject*) {
+    if (!GameBoy_check(self))
+        return nullptr;
+    if constexpr (TracePolicy::enabled)
+        self->gameboy->getCPU().tracer().clear();
+    Py_RETURN_NONE;
+}
+
+static PyObject* GameBoy_get_cycles(GameBoyObject* self, void*) {
+    if (!GameBoy_check(self))
+        return nullptr;
+    return PyLong_FromUnsignedLongLong(self->gameboy->getCycles());
+}
+
+static PyObject* GameBoy_get_frames(GameBoyObject* self, void*) {
+    if (!GameBoy_check(self))
+        return nullptr;
+    return PyLong_FromUnsignedLongLong(self->gameboy->getPPU().getFrames());
+}
+
+static PyObject* GameBoy_get_memory(GameBoyObject* self, void*) {
+    if (!GameBoy_check(self))
+        return nullptr;
+    // Writes would bypass the I/O handlers, so the full space is read-only
+    const uint8_t* data = self->gameboy->getMemory().raw();
+    return makeView(reinterpret_cast<PyObject*>(self), const_cast<uint8_t*>(data), "B", 1,
+                    {static_cast<Py_ssize_t>(Memory::MEMORY_SIZE)}, true);
+}
+
+static PyObject* GameBoy_get_wram(GameBoyObject* self, void*) {
+    if (!GameBoy_check(self))
+        return nullptr;
+    uint8_t* data = const_cast<uint8_t*>(self->gameboy->getMemory().raw());
+    return makeView(reinterpret_cast<PyObject*>(self), data + 0xC000, "B", 1, {0x2000}, false);
+}
+
+static PyObject* GameBoy_get_hram(GameBoyObject* self, void*) {
+    if (!GameBoy_check(self))
+        return nullptr;
+    uint8_t* data = const_cast<uint8_t*>(self->gameboy->getMemory().raw());
+    return makeView(reinterpret_cast<PyObject*>(self), data + 0xFF80, "B", 1, {0x7F}, false);
+}
+
+static PyObject* GameBoy_get_frame(GameBoyObject* self, void*) {
+    if (!GameBoy_check(self))
+        return nullptr;
+    const uint8_t* frame = self->gameboy->getPPU().frameBuffer();
+    return makeView(reinterpret_cast<PyObject*>(self), const_cast<uint8_t*>(frame), "B", 1,
+                    {PPU::SCREEN_HEIGHT, PPU::SCREEN_WIDTH}, true);
+}
+
+static PyObject* GameBoy_get_registers(GameBoyObject* self, void*) {
+    if (!GameBoy_check(self))
+        return nullptr;
+    return makeView(reinterpret_cast<PyObject*>(self), &self->gameboy->getRegisters(), "B", 1,
+                    {static_cast<Py_ssize_t>(sizeof(CPURegisters))}, false);
+}
+
+static PyObject* GameBoy_get_trace(GameBoyObject* self, void*) {
+    if (!GameBoy_check(self))
+        return nullptr;
+    void* records = nullptr;
+    Py_ssize_t count = 0;
+    if constexpr (TracePolicy::enabled) {
+        const BufferTrace& trace = self->gameboy->getCPU().tracer();
+        records = const_cast<TraceRecord*>(trace.records());
+        count = static_cast<Py_ssize_t>(trace.size());
+    }
+    static uint8_t none;
+    return makeView(reinterpret_cast<PyObject*>(self), records ? records : &none, "B", 1,
+                    {count, static_cast<Py_ssize_t>(sizeof(TraceRecord))}, true);
+}
+
+static PyMethodDef GameBoy_methods[] = {
+    {"reset", reinterpret_cast<PyCFunction>(GameBoy_reset), METH_NOARGS, "Power-on state for the loaded ROM"},
+    {"step", reinterpret_cast<PyCFunction>(GameBoy_step), METH_VARARGS, "step(n=1): execute n instructions"},
+    {"run_until", reinterpret_cast<PyCFunction>(GameBoy_run_until), METH_VARARGS,
+     "run_until(cycle): run until the cycle counter reaches cycle"},
+    {"run_frames", reinterpret_cast<PyCFunction>(GameBoy_run_frames), METH_VARARGS,
+     "run_frames(n=1): run until n more frames are complete"},
+    {"set_buttons", reinterpret_cast<PyCFunction>(GameBoy_set_buttons), METH_VARARGS,
+     "set_buttons(mask): hold the BUTTON_* bits in mask from now on"},
+    {"queue_inputs", reinterpret_cast<PyCFunction>(GameBoy_queue_inputs), METH_VARARGS,
+     "queue_inputs([(cycle, mask), ...]): button changes applied at their cycles"},
+    {"set_audio_mode", reinterpret_cast<PyCFunction>(GameBoy_set_audio_mode), METH_VARARGS,
+     "set_audio_mode('off' | 'silent' | 'full')"},
+    {"set_frame_skip", reinterpret_cast<PyCFunction>(GameBoy_set_frame_skip), METH_VARARGS,
+     "set_frame_skip(n): frames skipped after each rendered one (None = never render)"},
+    {"request_frame", reinterpret_cast<PyCFunction>(GameBoy_request_frame), METH_NOARGS,
+     "Render the next frame regardless of frame skipping"},
+    {"clear_trace", reinterpret_cast<PyCFunction>(GameBoy_clear_trace), METH_NOARGS,
+     "Discard buffered trace records"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyGetSetDef GameBoy_getset[] = {
+    {"cycles", reinterpret_cast<getter>(GameBoy_get_cycles), nullptr, "Cycles elapsed", nullptr},
+    {"frames", reinterpret_cast<getter>(GameBoy_get_frames), nullptr, "Frames completed", nullptr},
+    {"memory", reinterpret_cast<getter>(GameBoy_get_memory), nullptr,
+     "Read-only view of the 64 KiB address space (I/O registers as last stored)", nullptr},
+    {"wram", reinterpret_cast<getter>(GameBoy_get_wram), nullptr, "View of work RAM (0xC000-0xDFFF)", nullptr},
+    {"hram", reinterpret_cast<getter>(GameBoy_get_hram), nullptr, "View of high RAM (0xFF80-0xFFFE)", nullptr},
+    {"frame", reinterpret_cast<getter>(GameBoy_get_frame), nullptr,
+     "Read-only 144 x 160 view of the frame buffer (shades 0-3)", nullptr},
+    {"registers", reinterpret_cast<getter>(GameBoy_get_registers), nullptr,
+     "View of the register file laid out as REGISTER_FIELDS (keep F's low nibble clear)", nullptr},
+    {"trace", reinterpret_cast<getter>(GameBoy_get_trace), nullptr,
+     "Read-only records x TRACE_RECORD_SIZE view of buffered trace records (empty without GB_TRACE)", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr}
+};
+
+static PyTypeObject GameBoyType{};
+
+/////////////////////////  VecEnv  ////////////////////////////////
+
+struct VecEnvObject {
+    PyObject_HEAD
+    VecEnv* env;
+    // Arrays handed to VecEnv on every call (fixed after construction)
+    std::vector<uint8_t>* actions;
+    std::vector<uint8_t>* observations;
+    std::vector<float>* rewards;
+    std::vector<uint8_t>* dones;
+};
+
+static PyObject* VecEnv_new(PyTypeObject* type, PyObject*, PyObject*) {
+    VecEnvObject* self = reinterpret_cast<VecEnvObject*>(type->tp_alloc(type, 0));
+    if (self) {
+        self->env = nullptr;
+        self->actions = nullptr;
+        self->observations = nullptr;
+        self->rewards = nullptr;
+        self->dones = nullptr;
+    }
+    return reinterpret_cast<PyObject*>(self);
+}
+
+static void VecEnv_free(VecEnvObject* self) {
+    delete self->env;
+    delete self->actions;
+    delete self->observations;
+    delete self->rewards;
+    delete self->dones;
+    self->env = nullptr;
+}
+
+static int VecEnv_init(VecEnvObject* self, PyObject* args, PyObject* kwargs) {
+    // Views handed out so far point into the current arrays
+    if (self->env) {
+        PyErr_SetString(PyExc_RuntimeError, "VecEnv is already open");
+        return -1;
+    }
+    static const char* keywords[] = {"rom", "envs", "frames_per_step", "threads", "width", "height", "stack",
+                                     "shades", "max_episode_frames", "reward", "done", "audio", nullptr};
+    VecEnvConfig config;
+    const char* rom = nullptr;
+    Py_ssize_t envs = static_cast<Py_ssize_t>(config.envs);
+    unsigned int framesPerStep = config.framesPerStep;
+    unsigned int threads = config.threads;
+    int shades = 0;
+    unsigned long long maxEpisodeFrames = 0;
+    const char* reward = "";
+    const char* done = "";
+    const char* audio = "off";
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|nIIiiipKsss", const_cast<char**>(keywords), &rom, &envs,
+                                     &framesPerStep, &threads, &config.observation.width,
+                                     &config.observation.height, &config.observation.stack, &shades,
+                                     &maxEpisodeFrames, &reward, &done, &audio))
+        return -1;
+    if (envs < 1) {
+        PyErr_SetString(PyExc_ValueError, "envs must be at least 1");
+        return -1;
+    }
+    config.envs = static_cast<size_t>(envs);
+    config.framesPerStep = framesPerStep;
+    config.threads = threads;
+    config.maxEpisodeFrames = maxEpisodeFrames;
+    config.observation.format = shades ? ObservationSpec::SHADE_INDEX : ObservationSpec::LUMINANCE;
+    config.reward = reward;
+    config.done = done;
+    if (!parseAudioMode(audio, config.audio))
+        return -1;
+
+    auto env = std::make_unique<VecEnv>();
+    if (!env->open(rom, config)) {
+        PyErr_SetString(PyExc_RuntimeError, "VecEnv could not be opened (see stderr)");
+        return -1;
+    }
+    self->actions = new std::vector<uint8_t>(env->size());
+    self->observations = new std::vector<uint8_t>(env->size() * env->observationBytes());
+    self->rewards = new std::vector<float>(env->size());
+    self->dones = new std::vector<uint8_t>(env->size());
+    self->env = env.release();
+    return 0;
+}
+
+static void VecEnv_dealloc(VecEnvObject* self) {
+    VecEnv_free(self);
+    Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+static bool VecEnv_check(VecEnvObject* self) {
+    if (!self->env)
+        PyErr_SetString(PyExc_RuntimeError, "VecEnv is not open");
+    return self->env != nullptr;
+}
+
+static PyObject* VecEnv_reset(VecEnvObject* self, PyObject*) {
+    if (!VecEnv_check(self))
+        return nullptr;
+    VecEnv* env = self->env;
+    uint8_t* observations = self->observations->data();
+    Py_BEGIN_ALLOW_THREADS
+    env->reset(observations);
+    Py_END_ALLOW_THREADS
+    Py_RETURN_NONE;
+}
+
+static PyObject* VecEnv_step(VecEnvObject* self, PyObject* args) {
+    PyObject* actions = nullptr;
+    if (!VecEnv_check(self) || !PyArg_ParseTuple(args, "|O", &actions))
+        return nullptr;
+    if (actions && actions != Py_None) {
+        // Optional action array (any contiguous buffer of one byte per instance)
+        Py_buffer buffer;
+        if (PyObject_GetBuffer(actions, &buffer, PyBUF_C_CONTIGUOUS) < 0)
+            return nullptr;
+        bool sized = buffer.len == static_cast<Py_ssize_t>(self->actions->size());
+        if (sized)
+            memcpy(self->actions->data(), buffer.buf, self->actions->size());
+        PyBuffer_Release(&buffer);
+        if (!sized) {
+            PyErr_SetString(PyExc_ValueError, "actions must hold one byte per instance");
+            return nullptr;
+        }
+    }
+
+    VecEnv* env = self->env;
+    const uint8_t* actionData = self->actions->data();
+    uint8_t* observations = self->observations->data();
+    float* rewards = self->rewards->data();
+    uint8_t* dones = self->dones->data();
+    Py_BEGIN_ALLOW_THREADS
+    env->step(actionData, observations, rewards, dones);
+    Py_END_ALLOW_THREADS
+    Py_RETURN_NONE;
+}
+
+static PyObject* VecEnv_get_actions(VecEnvObject* self, void*) {
+    if (!VecEnv_check(self))
+        return nullptr;
+    return makeView(reinterpret_cast<PyObject*>(self), self->actions->data(), "B", 1,
+                    {static_cast<Py_ssize_t>(self->actions->size())}, false);
+}
+
+static PyObject* VecEnv_get_observations(VecEnvObject* self, void*) {
+    if (!VecEnv_check(self))
+        return nullptr;
+    const ObservationSpec& spec = self->env->getConfig().observation;
+    return makeView(reinterpret_cast<PyObject*>(self), self->observations->data(), "B", 1,
+                    {static_cast<Py_ssize_t>(self->env->size()), spec.stack, spec.height, spec.width}, true);
+}
+
+static PyObject* VecEnv_get_rewards(VecEnvObject* self, void*) {
+    if (!VecEnv_check(self))
+        return nullptr;
+    return makeView(reinterpret_cast<PyObject*>(self), self->rewards->data(), "f", sizeof(float),
+                    {static_cast<Py_ssize_t>(self->rewards->size())}, true);
+}
+
+static PyObject* VecEnv_get_dones(VecEnvObject* self, void*) {
+    if (!VecEnv_check(self))
+        return nullptr;
+    return makeView(reinterpret_cast<PyObject*>(self), self->dones->data(), "B", 1,
+                    {static_cast<Py_ssize_t>(self->dones->size())}, true);
+}
+
+static PyObject* VecEnv_len(VecEnvObject* self, void*) {
+    return PyLong_FromSize_t(self->env ? self->env->size() : 0);
+}
+
+static PyMethodDef VecEnv_methods[] = {
+    {"reset", reinterpret_cast<PyCFunction>(VecEnv_reset), METH_NOARGS,
+     "Start a new episode in every instance and write the first observations"},
+    {"step", reinterpret_cast<PyCFunction>(VecEnv_step), METH_VARARGS,
+     "step(actions=None): run one step with `actions` (or the actions array) and fill the output arrays"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+static PyGetSetDef VecEnv_getset[] = {
+    {"size", reinterpret_cast<getter>(VecEnv_len), nullptr, "Number of instances", nullptr},
+    {"actions", reinterpret_cast<getter>(VecEnv_get_actions), nullptr, "Button mask per instance", nullptr},
+    {"observations", reinterpret_cast<getter>(VecEnv_get_observations), nullptr,
+     "Read-only instances x stack x height x width observation view", nullptr},
+    {"rewards", reinterpret_cast<getter>(VecEnv_get_rewards), nullptr, "Read-only float32 reward per instance",
+     nullptr},
+    {"dones", reinterpret_cast<getter>(VecEnv_get_dones), nullptr, "Read-only done flag per instance", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr}
+};
+
+static PyTypeObject VecEnvType{};
+
+/////////////////////////  Module  ////////////////////////////////
+
+// ((name, offset, struct format), ...) for building numpy structured dtypes
+struct Field {
+    const char* name;
+    size_t offset;
+    const char* format;
+};
+
+#define FIELD(type, member, format) {#member, offsetof(type, member), format}
+
+static const Field REGISTER_FIELDS[] = {
+    FIELD(RegisterSnapshot, A, "B"), FIELD(RegisterSnapshot, F, "B"), FIELD(RegisterSnapshot, B, "B"),
+    FIELD(RegisterSnapshot, C, "B"), FIELD(RegisterSnapshot, D, "B"), FIELD(RegisterSnapshot, E, "B"),
+    FIELD(RegisterSnapshot, H, "B"), FIELD(RegisterSnapshot, L, "B"), FIELD(RegisterSnapshot, SP, "H"),
+    FIELD(RegisterSnapshot, PC, "H"),
+};
+
+static const Field TRACE_FIELDS[] = {
+    FIELD(TraceRecord, cycle, "Q"), FIELD(TraceRecord, pre, "12B"), FIELD(TraceRecord, post, "12B"),
+    FIELD(TraceRecord, mem, "16B"), FIELD(TraceRecord, pc, "H"), FIELD(TraceRecord, opcode, "B"),
+    FIELD(TraceRecord, operands, "2B"), FIELD(TraceRecord, operandCount, "B"),
+    FIELD(TraceRecord, memCount, "B"), FIELD(TraceRecord, cycles, "B"), FIELD(TraceRecord, dispatch, "B"),
+};
+
+#undef FIELD
+
+template <size_t N>
+static PyObject* fieldTuple(const Field (&fields)[N]) {
+    PyObject* tuple = PyTuple_New(N);
+    for (size_t i = 0; tuple && i < N; i++) {
+        PyObject* field = Py_BuildValue("(sns)", fields[i].name, static_cast<Py_ssize_t>(fields[i].offset),
+                                        fields[i].format);
+        if (!field) {
+            Py_DECREF(tuple);
+            return nullptr;
+        }
+        PyTuple_SET_ITEM(tuple, i, field);
+    }
+    return tuple;
+}
+
+static PyModuleDef module = {PyModuleDef_HEAD_INIT, "gbemu",
+                             "Game Boy emulator with zero-copy views of frames, memory, registers and traces",
+                             -1, nullptr, nullptr, nullptr, nullptr, nullptr};
+
+PyMODINIT_FUNC PyInit_gbemu() {
+    // The reference PyVarObject_HEAD_INIT would have given the static types
+    for (PyTypeObject* type : {&ViewType, &GameBoyType, &VecEnvType})
+        Py_SET_REFCNT(type, 1);
+
+    ViewType.tp_name = "gbemu.View";
+    ViewType.tp_basicsize = sizeof(ViewObject);
+    ViewType.tp_flags = Py_TPFLAGS_DEFAULT;
+    ViewType.tp_dealloc = reinterpret_cast<destructor>(View_dealloc);
+    ViewType.tp_as_buffer = &View_buffer;
+    ViewType.tp_doc = "Buffer exporter behind the memoryviews handed out by gbemu objects";
+
+    GameBoyType.tp_name = "gbemu.GameBoy";
+    GameBoyType.tp_basicsize = sizeof(GameBoyObject);
+    GameBoyType.tp_flags = Py_TPFLAGS_DEFAULT;
+    GameBoyType.tp_new = GameBoy_new;
+    GameBoyType.tp_init = reinterpret_cast<initproc>(GameBoy_init);
+    GameBoyType.tp_dealloc = reinterpret_cast<destructor>(GameBoy_dealloc);
+    GameBoyType.tp_methods = GameBoy_methods;
+    GameBoyType.tp_getset = GameBoy_getset;
+    GameBoyType.tp_doc = "GameBoy(rom, audio='full'): one emulated console";
+
+    VecEnvType.tp_name = "gbemu.VecEnv";
+    VecEnvType.tp_basicsize = sizeof(VecEnvObject);
+    VecEnvType.tp_flags = Py_TPFLAGS_DEFAULT;
+    VecEnvType.tp_new = VecEnv_new;
+    VecEnvType.tp_init = reinterpret_cast<initproc>(VecEnv_init);
+    VecEnvType.tp_dealloc = reinterpret_cast<destructor>(VecEnv_dealloc);
+    VecEnvType.tp_methods = VecEnv_methods;
+    VecEnvType.tp_getset = VecEnv_getset;
+    VecEnvType.tp_doc = "VecEnv(rom, envs=8, frames_per_step=4, threads=0, width=84, height=84, stack=1,\n"
+                        "       shades=False, max_episode_frames=0, reward='', done='', audio='off')\n"
+                        "reward and done are RAM expressions such as 'delta(bcd[C0A0:3])' and '[D000] == 1'";
+
+    if (PyType_Ready(&ViewType) < 0 || PyType_Ready(&GameBoyType) < 0 || PyType_Ready(&VecEnvType) < 0)
+        return nullptr;
+
+    PyObject* m = PyModule_Create(&module);
+    if (!m)
+        return nullptr;
+    Py_INCREF(&GameBoyType);
+    PyModule_AddObject(m, "GameBoy", reinterpret_cast<PyObject*>(&GameBoyType));
+    Py_INCREF(&VecEnvType);
+    PyModule_AddObject(m, "VecEnv", reinterpret_cast<PyObject*>(&VecEnvType));
+
+    const struct { const char* name; int value; } buttons[] = {
+        {"BUTTON_RIGHT", BUTTON_RIGHT}, {"BUTTON_LEFT", BUTTON_LEFT}, {"BUTTON_UP", BUTTON_UP},
+        {"BUTTON_DOWN", BUTTON_DOWN}, {"BUTTON_A", BUTTON_A}, {"BUTTON_B", BUTTON_B},
+        {"BUTTON_SELECT", BUTTON_SELECT}, {"BUTTON_START", BUTTON_START},
+    };
+    for (const auto& button : buttons)
+        PyModule_AddIntConstant(m, button.name, button.value);
+    PyModule_AddIntConstant(m, "TRACE_ENABLED", TracePolicy::enabled);
+    PyModule_AddIntConstant(m, "TRACE_RECORD_SIZE", static_cast<long>(sizeof(TraceRecord)));
+    PyModule_AddObject(m, "REGISTER_FIELDS", fieldTuple(REGISTER_FIELDS));
+    PyModule_AddObject(m, "TRACE_FIELDS", fieldTuple(TRACE_FIELDS));
+    return m;
+}
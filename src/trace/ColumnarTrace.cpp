@@ -0,0 +1,603 @@
+#include "ColumnarTrace.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "TraceEncoding.h"
+
+#ifdef GB_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef GB_HAVE_LZ4
+#include <lz4.h>
+#endif
+
+static constexpr char FILE_MAGIC[8] = {'G', 'B', 'C', 'O', 'L', 'T', 'R', '1'};
+static constexpr char FOOTER_MAGIC[4] = {'G', 'B', 'C', 'X'};
+static constexpr uint32_t FORMAT_VERSION = 1;
+static constexpr int COLUMN_COUNT = static_cast<int>(TraceColumn::Count);
+
+// Column payloads smaller than this are stored uncompressed
+static constexpr size_t MIN_COMPRESS_SIZE = 64;
+
+static size_t col(TraceColumn column) {
+    return static_cast<size_t>(column);
+}
+
+// Codecs that are not compiled in leave the parameters unused
+static bool compressColumn(TraceCodec codec, [[maybe_unused]] int level,
+                           [[maybe_unused]] const std::vector<uint8_t>& in,
+                           [[maybe_unused]] std::vector<uint8_t>& out) {
+    switch (codec) {
+#ifdef GB_HAVE_ZSTD
+        case TraceCodec::Zstd: {
+            out.resize(ZSTD_compressBound(in.size()));
+            size_t n = ZSTD_compress(out.data(), out.size(), in.data(), in.size(), level);
+            if (ZSTD_isError(n))
+                return false;
+            out.resize(n);
+            return true;
+        }
+#endif
+#ifdef GB_HAVE_LZ4
+        case TraceCodec::LZ4: {
+            out.resize(LZ4_compressBound(static_cast<int>(in.size())));
+            int n = LZ4_compress_default(reinterpret_cast<const char*>(in.data()),
+                                         reinterpret_cast<char*>(out.data()),
+                                         static_cast<int>(in.size()), static_cast<int>(out.size()));
+            if (n <= 0)
+                return false;
+            out.resize(static_cast<size_t>(n));
+            return true;
+        }
+#endif
+        default:
+            return false;
+    }
+}
+
+static bool decompressColumn(TraceCodec codec, const uint8_t* in, size_t size,
+                             std::vector<uint8_t>& out, size_t rawSize) {
+    out.resize(rawSize);
+    switch (codec) {
+        case TraceCodec::None:
+            if (size != rawSize)
+                return false;
+            std::memcpy(out.data(), in, size);
+            return true;
+#ifdef GB_HAVE_ZSTD
+        case TraceCodec::Zstd: {
+            size_t n = ZSTD_decompress(out.data(), rawSize, in, size);
+            return !ZSTD_isError(n) && n == rawSize;
+        }
+#endif
+#ifdef GB_HAVE_LZ4
+        case TraceCodec::LZ4: {
+            int n = LZ4_decompress_safe(reinterpret_cast<const char*>(in),
+                                        reinterpret_cast<char*>(out.data()),
+                                        static_cast<int>(size), static_cast<int>(rawSize));
+            return n >= 0 && static_cast<size_t>(n) == rawSize;
+        }
+#endif
+        default:
+            std::cerr << "ColumnarTraceReader: trace uses a codec that is not compiled in" << std::endl;
+            return false;
+    }
+}
+
+static void putSnapshot(std::vector<uint8_t>& out, const RegisterSnapshot& regs) {
+    const uint8_t bytes[8] = {regs.A, regs.F, regs.B, regs.C, regs.D, regs.E, regs.H, regs.L};
+    out.insert(out.end(), bytes, bytes + 8);
+    putFixed<uint16_t>(out, regs.SP);
+    putFixed<uint16_t>(out, regs.PC);
+}
+
+static bool getSnapshot(const uint8_t*& cursor, const uint8_t* end, RegisterSnapshot& regs) {
+    if (end - cursor < 8)
+        return false;
+    regs.A = cursor[0]; regs.F = cursor[1];
+    regs.B = cursor[2]; regs.C = cursor[3];
+    regs.D = cursor[4]; regs.E = cursor[5];
+    regs.H = cursor[6]; regs.L = cursor[7];
+    cursor += 8;
+    return getFixed(cursor, end, regs.SP) && getFixed(cursor, end, regs.PC);
+}
+
+static bool sameSnapshot(const RegisterSnapshot& a, const RegisterSnapshot& b) {
+    return std::memcmp(&a, &b, sizeof(RegisterSnapshot)) == 0;
+}
+
+/////////////////////////  Writer  ////////////////////////////////
+
+ColumnarTraceWriter::ColumnarTraceWriter(const TraceWriterOptions& options,
+                                         const ColumnarTraceOptions& columnarOptions)
+    : TraceWriter(options), columnar(columnarOptions) {
+    if (columnar.blockRecords == 0)
+        columnar.blockRecords = 1;
+    if (columnar.codec == TraceCodec::Auto) {
+        if (codecAvailable(TraceCodec::Zstd))
+            columnar.codec = TraceCodec::Zstd;
+        else if (codecAvailable(TraceCodec::LZ4))
+            columnar.codec = TraceCodec::LZ4;
+        else
+            columnar.codec = TraceCodec::None;
+    }
+    if (!codecAvailable(columnar.codec)) {
+        std::cerr << "ColumnarTraceWriter: requested codec not compiled in, storing columns uncompressed"
+                  << std::endl;
+        columnar.codec = TraceCodec::None;
+    }
+}
+
+ColumnarTraceWriter::~ColumnarTraceWriter() {
+    // Close here so the trailer is written through this class
+    close();
+}
+
+bool ColumnarTraceWriter::codecAvailable(TraceCodec codec) {
+    switch (codec) {
+        case TraceCodec::None:
+            return true;
+        case TraceCodec::LZ4:
+#ifdef GB_HAVE_LZ4
+            return true;
+#else
+            return false;
+#endif
+        case TraceCodec::Zstd:
+#ifdef GB_HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+        default:
+            return false;
+    }
+}
+
+void ColumnarTraceWriter::writeHeader() {
+    index.clear();
+    nextRecord = 0;
+
+    std::vector<uint8_t> header(FILE_MAGIC, FILE_MAGIC + 8);
+    putFixed<uint32_t>(header, FORMAT_VERSION);
+    putFixed<uint32_t>(header, COLUMN_COUNT);
+    writeBytes(header.data(), header.size());
+}
+
+void ColumnarTraceWriter::writeRecords(const TraceRecord* records, size_t count) {
+    while (count > 0) {
+        size_t n = std::min(count, columnar.blockRecords);
+        writeBlock(records, n);
+        records += n;
+        count -= n;
+    }
+}
+
+void ColumnarTraceWriter::writeBlock(const TraceRecord* records, size_t count) {
+    for (auto& stream : streams)
+        stream.clear();
+
+    uint64_t prevCycle = 0, prevPC = 0, prevSP = 0, prevAddress = 0;
+    std::vector<uint8_t> preEntries;
+    uint64_t preCount = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        const TraceRecord& r = records[i];
+
+        putDelta(streams[col(TraceColumn::Cycle)], r.cycle, prevCycle);
+        putDelta(streams[col(TraceColumn::PC)], r.pc, prevPC);
+        streams[col(TraceColumn::Opcode)].push_back(r.opcode);
+
+        std::vector<uint8_t>& operands = streams[col(TraceColumn::Operands)];
+        operands.push_back(r.operandCount);
+        operands.insert(operands.end(), r.operands, r.operands + r.operandCount);
+
+        streams[col(TraceColumn::A)].push_back(r.post.A);
+        streams[col(TraceColumn::F)].push_back(r.post.F);
+        streams[col(TraceColumn::B)].push_back(r.post.B);
+        streams[col(TraceColumn::C)].push_back(r.post.C);
+        streams[col(TraceColumn::D)].push_back(r.post.D);
+        streams[col(TraceColumn::E)].push_back(r.post.E);
+        streams[col(TraceColumn::H)].push_back(r.post.H);
+        streams[col(TraceColumn::L)].push_back(r.post.L);
+        putDelta(streams[col(TraceColumn::SP)], r.post.SP, prevSP);
+        putVarint(streams[col(TraceColumn::NextPC)],
+                  zigzagEncode(static_cast<int16_t>(r.post.PC - r.pc)));
+        streams[col(TraceColumn::Cycles)].push_back(r.cycles);
+
+        uint8_t flags = static_cast<uint8_t>(r.memCount | (r.dispatch << 3));
+        for (int m = 0; m < r.memCount; m++) {
+            if (r.mem[m].write)
+                flags |= 0x10 << m;
+            putDelta(streams[col(TraceColumn::MemAddress)], r.mem[m].address, prevAddress);
+            streams[col(TraceColumn::MemValue)].push_back(r.mem[m].value);
+        }
+        streams[col(TraceColumn::MemFlags)].push_back(flags);
+
+        // Pre-state is implied by the previous record unless the stream is discontinuous
+        if (i == 0 || !sameSnapshot(r.pre, records[i - 1].post)) {
+            putVarint(preEntries, i);
+            putSnapshot(preEntries, r.pre);
+            preCount++;
+        }
+    }
+
+    std::vector<uint8_t>& pre = streams[col(TraceColumn::PreState)];
+    putVarint(pre, preCount);
+    pre.insert(pre.end(), preEntries.begin(), preEntries.end());
+
+    // Instruction cycles take only a handful of distinct values
+    ColumnEncoding cyclesEncoding = ColumnEncoding::Raw8;
+    {
+        std::vector<uint8_t>& cycles = streams[col(TraceColumn::Cycles)];
+        uint8_t dict[16];
+        int dictSize = 0;
+        bool fits = true;
+        for (uint8_t value : cycles) {
+            if (std::find(dict, dict + dictSize, value) != dict + dictSize)
+                continue;
+            if (dictSize == 16) {
+                fits = false;
+                break;
+            }
+            dict[dictSize++] = value;
+        }
+        if (fits) {
+            std::vector<uint8_t> encoded;
+            encoded.push_back(static_cast<uint8_t>(dictSize));
+            encoded.insert(encoded.end(), dict, dict + dictSize);
+            for (size_t i = 0; i < cycles.size(); i += 2) {
+                uint8_t lo = static_cast<uint8_t>(std::find(dict, dict + dictSize, cycles[i]) - dict);
+                uint8_t hi = 0;
+                if (i + 1 < cycles.size())
+                    hi = static_cast<uint8_t>(std::find(dict, dict + dictSize, cycles[i + 1]) - dict);
+                encoded.push_back(static_cast<uint8_t>(lo | (hi << 4)));
+            }
+            cycles.swap(encoded);
+            cyclesEncoding = ColumnEncoding::Dict4;
+        }
+    }
+
+    // Block header and column directory, then payloads
+    block.clear();
+    putFixed<uint32_t>(block, static_cast<uint32_t>(count));
+    putFixed<uint32_t>(block, COLUMN_COUNT);
+    size_t directory = block.size();
+    block.resize(block.size() + COLUMN_COUNT * 12);
+
+    for (int c = 0; c < COLUMN_COUNT; c++) {
+        TraceColumn column = static_cast<TraceColumn>(c);
+        const std::vector<uint8_t>& rawStream = streams[c];
+
+        ColumnEncoding encoding;
+        switch (column) {
+            case TraceColumn::Cycle: case TraceColumn::PC: case TraceColumn::SP:
+            case TraceColumn::NextPC: case TraceColumn::MemAddress:
+                encoding = ColumnEncoding::Varint;
+                break;
+            case TraceColumn::Operands: case TraceColumn::PreState:
+                encoding = ColumnEncoding::Custom;
+                break;
+            case TraceColumn::Cycles:
+                encoding = cyclesEncoding;
+                break;
+            default:
+                encoding = ColumnEncoding::Raw8;
+                break;
+        }
+
+        TraceCodec codec = TraceCodec::None;
+        const std::vector<uint8_t>* payload = &rawStream;
+        if (columnar.codec != TraceCodec::None && rawStream.size() >= MIN_COMPRESS_SIZE &&
+            compressColumn(columnar.codec, columnar.level, rawStream, packed) &&
+            packed.size() < rawStream.size()) {
+            codec = columnar.codec;
+            payload = &packed;
+        }
+
+        uint8_t* entry = block.data() + directory + c * 12;
+        entry[0] = static_cast<uint8_t>(c);
+        entry[1] = static_cast<uint8_t>(encoding);
+        entry[2] = static_cast<uint8_t>(codec);
+        entry[3] = 0;
+        uint32_t storedSize = static_cast<uint32_t>(payload->size());
+        uint32_t rawSize = static_cast<uint32_t>(rawStream.size());
+        std::memcpy(entry + 4, &storedSize, 4);
+        std::memcpy(entry + 8, &rawSize, 4);
+        block.insert(block.end(), payload->begin(), payload->end());
+    }
+
+    TraceBlockInfo info;
+    info.firstRecord = nextRecord;
+    info.offset = bytesWritten();
+    info.recordCount = static_cast<uint32_t>(count);
+    info.size = static_cast<uint32_t>(block.size());
+    index.push_back(info);
+    nextRecord += count;
+
+    writeBytes(block.data(), block.size());
+}
+
+void ColumnarTraceWriter::writeTrailer() {
+    uint64_t indexOffset = bytesWritten();
+
+    std::vector<uint8_t> trailer;
+    for (const TraceBlockInfo& info : index) {
+        putFixed<uint64_t>(trailer, info.firstRecord);
+        putFixed<uint64_t>(trailer, info.offset);
+        putFixed<uint32_t>(trailer, info.recordCount);
+        putFixed<uint32_t>(trailer, info.size);
+    }
+    putFixed<uint64_t>(trailer, indexOffset);
+    putFixed<uint32_t>(trailer, static_cast<uint32_t>(index.size()));
+    trailer.insert(trailer.end(), FOOTER_MAGIC, FOOTER_MAGIC + 4);
+    writeBytes(trailer.data(), trailer.size());
+}
+
+/////////////////////////  Reader  ////////////////////////////////
+
+bool ColumnarTraceReader::open(const std::string& filename) {
+    file.close();
+    file.clear();
+    index.clear();
+    totalRecords = 0;
+
+    file.open(filename, std::ios::binary | std::ios::in);
+    if (!file.is_open()) {
+        std::cerr << "ColumnarTraceReader::open failed to open " << filename << std::endl;
+        return false;
+    }
+
+    char magic[8];
+    file.read(magic, 8);
+    if (!file || std::memcmp(magic, FILE_MAGIC, 8) != 0) {
+        std::cerr << "ColumnarTraceReader::open " << filename << " is not a columnar trace" << std::endl;
+        return false;
+    }
+
+    // Footer: u64 index offset, u32 block count, magic
+    uint8_t footer[16];
+    file.seekg(-16, std::ios::end);
+    const uint64_t footerOffset = static_cast<uint64_t>(file.tellg());
+    file.read(reinterpret_cast<char*>(footer), 16);
+    if (!file || std::memcmp(footer + 12, FOOTER_MAGIC, 4) != 0) {
+        std::cerr << "ColumnarTraceReader::open " << filename << " has no block index (unfinished trace?)"
+                  << std::endl;
+        return false;
+    }
+    uint64_t indexOffset;
+    uint32_t blockCount;
+    std::memcpy(&indexOffset, footer, 8);
+    std::memcpy(&blockCount, footer + 8, 4);
+
+    // The index sits between the last block and the footer
+    if (indexOffset < 8 || indexOffset > footerOffset ||
+        footerOffset - indexOffset != static_cast<uint64_t>(blockCount) * 24) {
+        std::cerr << "ColumnarTraceReader::open corrupt block index in " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> bytes(static_cast<size_t>(blockCount) * 24);
+    file.seekg(static_cast<std::streamoff>(indexOffset));
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file) {
+        std::cerr << "ColumnarTraceReader::open error reading index of " << filename << std::endl;
+        return false;
+    }
+
+    const uint8_t* cursor = bytes.data();
+    const uint8_t* end = cursor + bytes.size();
+    for (uint32_t b = 0; b < blockCount; b++) {
+        TraceBlockInfo info;
+        bool ok = getFixed(cursor, end, info.firstRecord) && getFixed(cursor, end, info.offset) &&
+                  getFixed(cursor, end, info.recordCount) && getFixed(cursor, end, info.size);
+        // Blocks lie before the index and number the records contiguously from 0
+        if (!ok || info.offset < 8 || info.offset > indexOffset || info.size > indexOffset - info.offset ||
+            info.firstRecord != totalRecords) {
+            std::cerr << "ColumnarTraceReader::open corrupt block index in " << filename << std::endl;
+            index.clear();
+            totalRecords = 0;
+            return false;
+        }
+        index.push_back(info);
+        totalRecords = info.firstRecord + info.recordCount;
+    }
+    return true;
+}
+
+bool ColumnarTraceReader::read(uint64_t first, size_t count, uint32_t columns,
+                               std::vector<TraceRecord>& out) {
+    out.clear();
+    if (first >= totalRecords || count == 0)
+        return first <= totalRecords;
+    uint64_t last = std::min<uint64_t>(first + count, totalRecords);
+
+    // First block whose range contains `first`
+    auto it = std::upper_bound(index.begin(), index.end(), first,
+        [](uint64_t record, const TraceBlockInfo& info) { return record < info.firstRecord; });
+    size_t b = static_cast<size_t>(it - index.begin()) - 1;
+
+    std::vector<TraceRecord> decoded;
+    for (; b < index.size() && index[b].firstRecord < last; b++) {
+        if (!readBlock(b, columns, decoded))
+            return false;
+        uint64_t from = std::max(first, index[b].firstRecord) - index[b].firstRecord;
+        uint64_t to = std::min(last, index[b].firstRecord + index[b].recordCount) - index[b].firstRecord;
+        out.insert(out.end(), decoded.begin() + from, decoded.begin() + to);
+    }
+    return true;
+}
+
+bool ColumnarTraceReader::readBlock(size_t blockIndex, uint32_t columns, std::vector<TraceRecord>& out) {
+    const TraceBlockInfo& info = index[blockIndex];
+
+    // Columns needed to rebuild the requested ones
+    if (columns & columnBit(TraceColumn::PreState))
+        columns |= columnBit(TraceColumn::A) | columnBit(TraceColumn::F) | columnBit(TraceColumn::B) |
+                   columnBit(TraceColumn::C) | columnBit(TraceColumn::D) | columnBit(TraceColumn::E) |
+                   columnBit(TraceColumn::H) | columnBit(TraceColumn::L) | columnBit(TraceColumn::SP) |
+                   columnBit(TraceColumn::NextPC);
+    if (columns & columnBit(TraceColumn::NextPC))
+        columns |= columnBit(TraceColumn::PC);
+    if (columns & (columnBit(TraceColumn::MemFlags) | columnBit(TraceColumn::MemAddress) |
+                   columnBit(TraceColumn::MemValue)))
+        columns |= columnBit(TraceColumn::MemFlags) | columnBit(TraceColumn::MemAddress) |
+                   columnBit(TraceColumn::MemValue);
+
+    // Block header and directory first, then only the payloads we need
+    size_t headerSize = 8 + COLUMN_COUNT * 12;
+    stored.resize(headerSize);
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(info.offset));
+    file.read(reinterpret_cast<char*>(stored.data()), static_cast<std::streamsize>(headerSize));
+    if (!file) {
+        std::cerr << "ColumnarTraceReader: error reading block " << blockIndex << std::endl;
+        return false;
+    }
+
+    uint32_t recordCount, columnCount;
+    std::memcpy(&recordCount, stored.data(), 4);
+    std::memcpy(&columnCount, stored.data() + 4, 4);
+    if (recordCount != info.recordCount || columnCount != COLUMN_COUNT) {
+        std::cerr << "ColumnarTraceReader: block " << blockIndex << " does not match the index" << std::endl;
+        return false;
+    }
+
+    uint8_t encodings[COLUMN_COUNT];
+    std::vector<uint8_t> payload;
+    uint64_t offset = info.offset + headerSize;
+    for (int c = 0; c < COLUMN_COUNT; c++) {
+        const uint8_t* entry = stored.data() + 8 + c * 12;
+        uint32_t storedSize, rawSize;
+        std::memcpy(&storedSize, entry + 4, 4);
+        std::memcpy(&rawSize, entry + 8, 4);
+        encodings[c] = entry[1];
+
+        if (columns & (1u << c)) {
+            payload.resize(storedSize);
+            file.seekg(static_cast<std::streamoff>(offset));
+            file.read(reinterpret_cast<char*>(payload.data()), static_cast<std::streamsize>(storedSize));
+            if (!file || !decompressColumn(static_cast<TraceCodec>(entry[2]), payload.data(), storedSize,
+                                           raw[c], rawSize)) {
+                std::cerr << "ColumnarTraceReader: bad column " << c << " in block " << blockIndex << std::endl;
+                return false;
+            }
+        }
+        offset += storedSize;
+    }
+
+    out.assign(recordCount, TraceRecord{});
+    auto want = [columns](TraceColumn column) { return (columns & columnBit(column)) != 0; };
+    auto stream = [this](TraceColumn column) -> const std::vector<uint8_t>& { return raw[col(column)]; };
+    bool ok = true;
+
+    auto decodeDelta = [&](TraceColumn column, auto assign) {
+        const uint8_t* cursor = stream(column).data();
+        const uint8_t* end = cursor + stream(column).size();
+        uint64_t value = 0;
+        for (uint32_t i = 0; i < recordCount && ok; i++) {
+            ok = getDelta(cursor, end, value);
+            assign(out[i], value);
+        }
+    };
+    auto decodeBytes = [&](TraceColumn column, auto assign) {
+        if (stream(column).size() < recordCount) {
+            ok = false;
+            return;
+        }
+        for (uint32_t i = 0; i < recordCount; i++)
+            assign(out[i], stream(column)[i]);
+    };
+
+    if (want(TraceColumn::Cycle))
+        decodeDelta(TraceColumn::Cycle, [](TraceRecord& r, uint64_t v) { r.cycle = v; });
+    if (want(TraceColumn::PC))
+        decodeDelta(TraceColumn::PC, [](TraceRecord& r, uint64_t v) { r.pc = static_cast<uint16_t>(v); r.pre.PC = r.pc; });
+    if (want(TraceColumn::Opcode))
+        decodeBytes(TraceColumn::Opcode, [](TraceRecord& r, uint8_t v) { r.opcode = v; });
+    if (want(TraceColumn::Operands)) {
+        const uint8_t* cursor = stream(TraceColumn::Operands).data();
+        const uint8_t* end = cursor + stream(TraceColumn::Operands).size();
+        for (uint32_t i = 0; i < recordCount && ok; i++) {
+            ok = cursor < end && *cursor <= 2 && end - cursor > *cursor;
+            if (!ok)
+                break;
+            out[i].operandCount = *cursor++;
+            for (int j = 0; j < out[i].operandCount; j++)
+                out[i].operands[j] = *cursor++;
+        }
+    }
+    if (want(TraceColumn::A)) decodeBytes(TraceColumn::A, [](TraceRecord& r, uint8_t v) { r.post.A = v; });
+    if (want(TraceColumn::F)) decodeBytes(TraceColumn::F, [](TraceRecord& r, uint8_t v) { r.post.F = v; });
+    if (want(TraceColumn::B)) decodeBytes(TraceColumn::B, [](TraceRecord& r, uint8_t v) { r.post.B = v; });
+    if (want(TraceColumn::C)) decodeBytes(TraceColumn::C, [](TraceRecord& r, uint8_t v) { r.post.C = v; });
+    if (want(TraceColumn::D)) decodeBytes(TraceColumn::D, [](TraceRecord& r, uint8_t v) { r.post.D = v; });
+    if (want(TraceColumn::E)) decodeBytes(TraceColumn::E, [](TraceRecord& r, uint8_t v) { r.post.E = v; });
+    if (want(TraceColumn::H)) decodeBytes(TraceColumn::H, [](TraceRecord& r, uint8_t v) { r.post.H = v; });
+    if (want(TraceColumn::L)) decodeBytes(TraceColumn::L, [](TraceRecord& r, uint8_t v) { r.post.L = v; });
+    if (want(TraceColumn::SP))
+        decodeDelta(TraceColumn::SP, [](TraceRecord& r, uint64_t v) { r.post.SP = static_cast<uint16_t>(v); });
+    if (want(TraceColumn::NextPC)) {
+        const uint8_t* cursor = stream(TraceColumn::NextPC).data();
+        const uint8_t* end = cursor + stream(TraceColumn::NextPC).size();
+        for (uint32_t i = 0; i < recordCount && ok; i++) {
+            uint64_t v;
+            ok = getVarint(cursor, end, v);
+            out[i].post.PC = static_cast<uint16_t>(out[i].pc + zigzagDecode(v));
+        }
+    }
+    if (want(TraceColumn::Cycles)) {
+        const std::vector<uint8_t>& cycles = stream(TraceColumn::Cycles);
+        if (encodings[col(TraceColumn::Cycles)] == static_cast<uint8_t>(ColumnEncoding::Dict4)) {
+            size_t dictSize = cycles.empty() ? 0 : cycles[0];
+            ok = ok && cycles.size() >= 1 + dictSize + (recordCount + 1) / 2;
+            for (uint32_t i = 0; i < recordCount && ok; i++) {
+                uint8_t packedByte = cycles[1 + dictSize + i / 2];
+                uint8_t code = (i & 1) ? (packedByte >> 4) : (packedByte & 0x0F);
+                ok = code < dictSize;
+                if (ok)
+                    out[i].cycles = cycles[1 + code];
+            }
+        } else {
+            decodeBytes(TraceColumn::Cycles, [](TraceRecord& r, uint8_t v) { r.cycles = v; });
+        }
+    }
+    if (want(TraceColumn::MemFlags)) {
+        decodeBytes(TraceColumn::MemFlags, [](TraceRecord& r, uint8_t v) {
+            r.memCount = v & 0x07;
+            r.dispatch = (v >> 3) & 1;
+            for (int m = 0; m < TraceRecord::MAX_MEM_ACCESSES; m++)
+                r.mem[m].write = (v >> (4 + m)) & 1;
+        });
+        const uint8_t* cursor = stream(TraceColumn::MemAddress).data();
+        const uint8_t* end = cursor + stream(TraceColumn::MemAddress).size();
+        const std::vector<uint8_t>& values = stream(TraceColumn::MemValue);
+        size_t valueIndex = 0;
+        uint64_t address = 0;
+        for (uint32_t i = 0; i < recordCount && ok; i++) {
+            for (int m = 0; m < out[i].memCount && ok; m++) {
+                ok = getDelta(cursor, end, address) && valueIndex < values.size();
+                out[i].mem[m].address = static_cast<uint16_t>(address);
+                out[i].mem[m].value = ok ? values[valueIndex++] : 0;
+            }
+        }
+    }
+    if (want(TraceColumn::PreState)) {
+        for (uint32_t i = 1; i < recordCount; i++)
+            out[i].pre = out[i - 1].post;
+        const uint8_t* cursor = stream(TraceColumn::PreState).data();
+        const uint8_t* end = cursor + stream(TraceColumn::PreState).size();
+        uint64_t entries = 0;
+        ok = ok && getVarint(cursor, end, entries);
+        for (uint64_t e = 0; e < entries && ok; e++) {
+            uint64_t i;
+            ok = getVarint(cursor, end, i) && i < recordCount;
+            if (ok)
+                ok = getSnapshot(cursor, end, out[i].pre);
+        }
+    }
+
+    if (!ok)
+        std::cerr << "ColumnarTraceReader: corrupt data in block " << blockIndex << std::endl;
+    return ok;
+}
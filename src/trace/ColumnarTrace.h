@@ -0,0 +1,125 @@
+#ifndef COLUMNARTRACE_H
+#define COLUMNARTRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "TraceWriter.h"
+
+// Columnar trace file format ("GBCOLTR1"), all fields little-endian:
+//
+//   header   magic[8] "GBCOLTR1", u32 version, u32 column count
+//   block*   u32 record count, u32 column count,
+//            column count x { u8 column, u8 encoding, u8 codec, u8 0, u32 stored size, u32 raw size },
+//            column payloads in directory order
+//   index    block count x { u64 first record, u64 file offset, u32 record count, u32 block size }
+//   footer   u64 index offset, u32 block count, magic[4] "GBCX"
+//
+// Every block is self-contained (delta bases restart at zero), so a reader can
+// seek to any instruction range through the index and decode only the columns
+// it needs.
+
+// Column streams of a block
+enum class TraceColumn : uint8_t {
+    Cycle,       // Start cycle, zigzag delta varint
+    PC,          // Opcode address, zigzag delta varint
+    Opcode,      // Raw bytes
+    Operands,    // Operand count byte followed by the operand bytes
+    A, F, B, C, D, E, H, L,  // Post-instruction registers, raw bytes
+    SP,          // Post-instruction SP, zigzag delta varint
+    NextPC,      // Post-instruction PC minus PC, zigzag varint
+    Cycles,      // Instruction cycles, dictionary or raw
+    MemFlags,    // Access count (bits 0-2), interrupt dispatch (bit 3), write flags (bits 4-7)
+    MemAddress,  // Per access, zigzag delta varint
+    MemValue,    // Per access, raw bytes
+    PreState,    // Records whose pre-state is not the previous post-state
+    Count
+};
+
+inline constexpr uint32_t columnBit(TraceColumn column) {
+    return 1u << static_cast<uint32_t>(column);
+}
+
+static constexpr uint32_t TRACE_COLUMNS_ALL = (1u << static_cast<uint32_t>(TraceColumn::Count)) - 1;
+
+// How a column payload is encoded before compression
+enum class ColumnEncoding : uint8_t {
+    Raw8,
+    Varint,
+    Dict4,   // Up to 16 distinct byte values, 4-bit indices
+    Custom   // Column-specific layout described above
+};
+
+// Block-level compression
+enum class TraceCodec : uint8_t {
+    None,
+    LZ4,
+    Zstd,
+    Auto = 0xFF  // Best codec compiled in (never stored in files)
+};
+
+struct ColumnarTraceOptions {
+    TraceCodec codec = TraceCodec::Auto;  // Zstd, else LZ4, else uncompressed
+    int level = 3;                        // Zstd compression level
+    size_t blockRecords = 1 << 14;        // Records per block (seek granularity)
+};
+
+// Index entry for one block
+struct TraceBlockInfo {
+    uint64_t firstRecord;
+    uint64_t offset;
+    uint32_t recordCount;
+    uint32_t size;
+};
+
+// TraceWriter that stores records column by column
+class ColumnarTraceWriter : public TraceWriter {
+public:
+    explicit ColumnarTraceWriter(const TraceWriterOptions& options = TraceWriterOptions(),
+                                 const ColumnarTraceOptions& columnar = ColumnarTraceOptions());
+    ~ColumnarTraceWriter() override;
+
+    static bool codecAvailable(TraceCodec codec);
+
+protected:
+    void writeHeader() override;
+    void writeRecords(const TraceRecord* records, size_t count) override;
+    void writeTrailer() override;
+
+private:
+    void writeBlock(const TraceRecord* records, size_t count);
+
+    ColumnarTraceOptions columnar;
+    std::vector<TraceBlockInfo> index;
+    uint64_t nextRecord = 0;
+
+    std::vector<uint8_t> streams[static_cast<int>(TraceColumn::Count)];
+    std::vector<uint8_t> block;
+    std::vector<uint8_t> packed;
+};
+
+// Random-access reader for columnar trace files
+class ColumnarTraceReader {
+public:
+    bool open(const std::string& filename);
+
+    uint64_t recordCount() const { return totalRecords; }
+    const std::vector<TraceBlockInfo>& blocks() const { return index; }
+
+    // Decode records [first, first + count). Only fields belonging to the
+    // requested columns (plus the columns they depend on) are filled in.
+    bool read(uint64_t first, size_t count, uint32_t columns, std::vector<TraceRecord>& out);
+
+private:
+    bool readBlock(size_t blockIndex, uint32_t columns, std::vector<TraceRecord>& out);
+
+    std::ifstream file;
+    std::vector<TraceBlockInfo> index;
+    uint64_t totalRecords = 0;
+    std::vector<uint8_t> stored;
+    std::vector<uint8_t> raw[static_cast<int>(TraceColumn::Count)];
+};
+
+#endif // COLUMNARTRACE_H
@@ -0,0 +1,393 @@
+#include "DiffTrace.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "TraceEncoding.h"
+
+static constexpr char FILE_MAGIC[8] = {'G', 'B', 'D', 'I', 'F', 'F', '0', '1'};
+static constexpr char FOOTER_MAGIC[4] = {'G', 'B', 'D', 'X'};
+static constexpr uint8_t CHUNK_KEYFRAME = 0;
+static constexpr uint8_t CHUNK_RECORDS = 1;
+
+static void putRegisters(std::vector<uint8_t>& out, const RegisterSnapshot& regs) {
+    const uint8_t bytes[8] = {regs.A, regs.F, regs.B, regs.C, regs.D, regs.E, regs.H, regs.L};
+    out.insert(out.end(), bytes, bytes + 8);
+    putFixed<uint16_t>(out, regs.SP);
+    putFixed<uint16_t>(out, regs.PC);
+}
+
+static bool getRegisters(const uint8_t*& cursor, const uint8_t* end, RegisterSnapshot& regs) {
+    if (end - cursor < 8)
+        return false;
+    regs.A = cursor[0]; regs.F = cursor[1];
+    regs.B = cursor[2]; regs.C = cursor[3];
+    regs.D = cursor[4]; regs.E = cursor[5];
+    regs.H = cursor[6]; regs.L = cursor[7];
+    cursor += 8;
+    return getFixed(cursor, end, regs.SP) && getFixed(cursor, end, regs.PC);
+}
+
+static void putAccesses(std::vector<uint8_t>& out, const MemoryAccess* accesses, int count) {
+    out.push_back(static_cast<uint8_t>(count));
+    for (int i = 0; i < count; i++) {
+        putFixed<uint16_t>(out, accesses[i].address);
+        out.push_back(accesses[i].value);
+    }
+}
+
+static bool getAccesses(const uint8_t*& cursor, const uint8_t* end, MemoryAccess* accesses,
+                        uint8_t& count, uint8_t write) {
+    if (cursor >= end || *cursor > TraceRecord::MAX_MEM_ACCESSES)
+        return false;
+    count = *cursor++;
+    for (int i = 0; i < count; i++) {
+        if (!getFixed(cursor, end, accesses[i].address) || cursor >= end)
+            return false;
+        accesses[i].value = *cursor++;
+        accesses[i].write = write;
+    }
+    return true;
+}
+
+/////////////////////////  Writer  ////////////////////////////////
+
+DiffTraceWriter::DiffTraceWriter(const TraceWriterOptions& options, uint32_t keyframeInterval)
+    : TraceWriter(options), interval(keyframeInterval ? keyframeInterval : 1),
+      shadow(Memory::MEMORY_SIZE, 0) {
+}
+
+DiffTraceWriter::~DiffTraceWriter() {
+    // Close here so the trailer is written through this class
+    close();
+}
+
+bool DiffTraceWriter::open(const std::string& filename, const Memory& initialMemory) {
+    // The writer thread is not running yet, so the shadow copy can be taken here
+    close();
+    initialMemory.saveState(shadow.data());
+    return TraceWriter::open(filename);
+}
+
+void DiffTraceWriter::writeHeader() {
+    index.clear();
+    nextRecord = 0;
+    lastEnd = 0;
+
+    std::vector<uint8_t> header(FILE_MAGIC, FILE_MAGIC + 8);
+    putFixed<uint32_t>(header, interval);
+    putFixed<uint32_t>(header, 0);
+    writeBytes(header.data(), header.size());
+}
+
+void DiffTraceWriter::writeKeyframe(const TraceRecord& next) {
+    index.push_back({nextRecord, bytesWritten()});
+
+    // A keyframe describes the state right before `next` executes
+    registers = next.pre;
+    lastEnd = next.cycle;
+
+    std::vector<uint8_t> head;
+    head.push_back(CHUNK_KEYFRAME);
+    putFixed<uint64_t>(head, nextRecord);
+    putFixed<uint64_t>(head, next.cycle);
+    putRegisters(head, registers);
+    writeBytes(head.data(), head.size());
+    writeBytes(shadow.data(), shadow.size());
+}
+
+void DiffTraceWriter::encode(const TraceRecord& r, std::vector<uint8_t>& out) {
+    MemoryAccess inputs[TraceRecord::MAX_MEM_ACCESSES];
+    MemoryAccess writes[TraceRecord::MAX_MEM_ACCESSES];
+    int inputCount = 0;
+    int writeCount = 0;
+
+    // Replay accesses in order against the shadow memory: reads that do not
+    // match were changed behind the CPU's back and become inputs
+    for (int m = 0; m < r.memCount; m++) {
+        const MemoryAccess& access = r.mem[m];
+        if (access.write) {
+            writes[writeCount++] = access;
+            shadow[access.address] = access.value;
+        } else if (shadow[access.address] != access.value) {
+            inputs[inputCount++] = access;
+            shadow[access.address] = access.value;
+        }
+    }
+
+    uint8_t length = r.dispatch ? 0 : static_cast<uint8_t>(1 + r.operandCount);
+    uint32_t changed = 0;
+    if (std::memcmp(&r.pre, &registers, sizeof(RegisterSnapshot)) != 0)
+        changed |= DIFF_PRESTATE;
+    if (r.cycle != lastEnd)
+        changed |= DIFF_CYCLEGAP;
+    if (inputCount)
+        changed |= DIFF_INPUTS;
+    if (r.post.A != r.pre.A) changed |= DIFF_A;
+    if (r.post.F != r.pre.F) changed |= DIFF_F;
+    if (r.post.B != r.pre.B) changed |= DIFF_B;
+    if (r.post.C != r.pre.C) changed |= DIFF_C;
+    if (r.post.D != r.pre.D) changed |= DIFF_D;
+    if (r.post.E != r.pre.E) changed |= DIFF_E;
+    if (r.post.H != r.pre.H) changed |= DIFF_H;
+    if (r.post.L != r.pre.L) changed |= DIFF_L;
+    if (r.post.SP != r.pre.SP) changed |= DIFF_SP;
+    if (r.post.PC != static_cast<uint16_t>(r.pc + length)) changed |= DIFF_JUMP;
+    if (writeCount)
+        changed |= DIFF_WRITES;
+
+    putVarint(out, changed);
+    if (changed & DIFF_PRESTATE)
+        putRegisters(out, r.pre);
+    if (changed & DIFF_CYCLEGAP)
+        putVarint(out, r.cycle - lastEnd);
+    if (changed & DIFF_INPUTS)
+        putAccesses(out, inputs, inputCount);
+    if (changed & DIFF_A) out.push_back(r.post.A);
+    if (changed & DIFF_F) out.push_back(r.post.F);
+    if (changed & DIFF_B) out.push_back(r.post.B);
+    if (changed & DIFF_C) out.push_back(r.post.C);
+    if (changed & DIFF_D) out.push_back(r.post.D);
+    if (changed & DIFF_E) out.push_back(r.post.E);
+    if (changed & DIFF_H) out.push_back(r.post.H);
+    if (changed & DIFF_L) out.push_back(r.post.L);
+    if (changed & DIFF_SP)
+        putFixed<uint16_t>(out, r.post.SP);
+    if (changed & DIFF_JUMP)
+        putFixed<uint16_t>(out, r.post.PC);
+    if (changed & DIFF_WRITES)
+        putAccesses(out, writes, writeCount);
+    out.push_back(r.cycles);
+    out.push_back(length);
+
+    registers = r.post;
+    lastEnd = r.cycle + r.cycles;
+}
+
+void DiffTraceWriter::writeRecords(const TraceRecord* records, size_t count) {
+    while (count > 0) {
+        if (nextRecord % interval == 0)
+            writeKeyframe(*records);
+
+        // Records up to the next keyframe go into one chunk
+        size_t n = std::min<uint64_t>(count, interval - nextRecord % interval);
+        payload.clear();
+        for (size_t i = 0; i < n; i++)
+            encode(records[i], payload);
+
+        std::vector<uint8_t> head;
+        head.push_back(CHUNK_RECORDS);
+        putFixed<uint32_t>(head, static_cast<uint32_t>(n));
+        putFixed<uint32_t>(head, static_cast<uint32_t>(payload.size()));
+        writeBytes(head.data(), head.size());
+        writeBytes(payload.data(), payload.size());
+
+        nextRecord += n;
+        records += n;
+        count -= n;
+    }
+}
+
+void DiffTraceWriter::writeTrailer() {
+    uint64_t indexOffset = bytesWritten();
+
+    std::vector<uint8_t> trailer;
+    for (const DiffIndexEntry& entry : index) {
+        putFixed<uint64_t>(trailer, entry.record);
+        putFixed<uint64_t>(trailer, entry.offset);
+    }
+    putFixed<uint64_t>(trailer, indexOffset);
+    putFixed<uint32_t>(trailer, static_cast<uint32_t>(index.size()));
+    trailer.insert(trailer.end(), FOOTER_MAGIC, FOOTER_MAGIC + 4);
+    writeBytes(trailer.data(), trailer.size());
+}
+
+/////////////////////////  Reader  ////////////////////////////////
+
+bool DiffTraceReader::open(const std::string& filename) {
+    file.close();
+    file.clear();
+    index.clear();
+    totalRecords = 0;
+
+    file.open(filename, std::ios::binary | std::ios::in);
+    if (!file.is_open()) {
+        std::cerr << "DiffTraceReader::open failed to open " << filename << std::endl;
+        return false;
+    }
+
+    char magic[8];
+    file.read(magic, 8);
+    if (!file || std::memcmp(magic, FILE_MAGIC, 8) != 0) {
+        std::cerr << "DiffTraceReader::open " << filename << " is not a state-diff trace" << std::endl;
+        return false;
+    }
+
+    uint8_t footer[16];
+    file.seekg(-16, std::ios::end);
+    file.read(reinterpret_cast<char*>(footer), 16);
+    if (!file || std::memcmp(footer + 12, FOOTER_MAGIC, 4) != 0) {
+        std::cerr << "DiffTraceReader::open " << filename << " has no keyframe index (unfinished trace?)"
+                  << std::endl;
+        return false;
+    }
+    uint32_t count;
+    std::memcpy(&dataEnd, footer, 8);
+    std::memcpy(&count, footer + 8, 4);
+
+    std::vector<uint8_t> bytes(static_cast<size_t>(count) * 16);
+    file.seekg(static_cast<std::streamoff>(dataEnd));
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file) {
+        std::cerr << "DiffTraceReader::open error reading index of " << filename << std::endl;
+        return false;
+    }
+    const uint8_t* cursor = bytes.data();
+    const uint8_t* end = cursor + bytes.size();
+    for (uint32_t k = 0; k < count; k++) {
+        DiffIndexEntry entry;
+        bool ok = getFixed(cursor, end, entry.record) && getFixed(cursor, end, entry.offset);
+        // Segments are read from one offset to the next, so they must be in order
+        if (!ok || entry.offset >= dataEnd || (!index.empty() && entry.offset <= index.back().offset)) {
+            std::cerr << "DiffTraceReader::open corrupt keyframe index in " << filename << std::endl;
+            index.clear();
+            return false;
+        }
+        index.push_back(entry);
+    }
+
+    // Count the records of the last segment to know the total
+    if (!index.empty()) {
+        DiffKeyframe keyframe;
+        std::vector<DiffRecord> records;
+        if (!readSegment(index.size() - 1, keyframe, records))
+            return false;
+        totalRecords = index.back().record + records.size();
+    }
+    return true;
+}
+
+bool DiffTraceReader::readSegment(size_t k, DiffKeyframe& keyframe, std::vector<DiffRecord>& records) {
+    records.clear();
+    if (k >= index.size())
+        return false;
+
+    uint64_t start = index[k].offset;
+    uint64_t stop = k + 1 < index.size() ? index[k + 1].offset : dataEnd;
+    std::vector<uint8_t> bytes(static_cast<size_t>(stop - start));
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(start));
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file) {
+        std::cerr << "DiffTraceReader: error reading segment " << k << std::endl;
+        return false;
+    }
+
+    const uint8_t* cursor = bytes.data();
+    const uint8_t* end = cursor + bytes.size();
+    if (end - cursor < 1 + 8 + 8 + 12 + static_cast<long>(Memory::MEMORY_SIZE) || *cursor++ != CHUNK_KEYFRAME) {
+        std::cerr << "DiffTraceReader: segment " << k << " does not start with a keyframe" << std::endl;
+        return false;
+    }
+    getFixed(cursor, end, keyframe.record);
+    getFixed(cursor, end, keyframe.cycle);
+    getRegisters(cursor, end, keyframe.registers);
+    keyframe.memory.assign(cursor, cursor + Memory::MEMORY_SIZE);
+    cursor += Memory::MEMORY_SIZE;
+
+    RegisterSnapshot regs = keyframe.registers;
+    uint64_t lastEnd = keyframe.cycle;
+    bool ok = true;
+
+    while (ok && cursor < end) {
+        if (*cursor++ != CHUNK_RECORDS) {
+            ok = false;
+            break;
+        }
+        uint32_t count, size;
+        ok = getFixed(cursor, end, count) && getFixed(cursor, end, size) &&
+             static_cast<size_t>(end - cursor) >= size;
+        const uint8_t* payloadEnd = cursor + size;
+
+        for (uint32_t i = 0; ok && i < count; i++) {
+            DiffRecord r;
+            uint64_t mask;
+            ok = getVarint(cursor, payloadEnd, mask);
+            if (!ok)
+                break;
+            r.changed = static_cast<uint32_t>(mask);
+            r.inputCount = 0;
+            r.writeCount = 0;
+
+            if (r.changed & DIFF_PRESTATE)
+                ok = ok && getRegisters(cursor, payloadEnd, regs);
+            uint64_t gap = 0;
+            if (r.changed & DIFF_CYCLEGAP)
+                ok = ok && getVarint(cursor, payloadEnd, gap);
+            r.cycle = lastEnd + gap;
+            if (r.changed & DIFF_INPUTS)
+                ok = ok && getAccesses(cursor, payloadEnd, r.inputs, r.inputCount, 0);
+
+            r.pre = regs;
+            r.post = regs;
+            auto byte = [&](uint32_t field, uint8_t& value) {
+                if (ok && (r.changed & field)) {
+                    ok = cursor < payloadEnd;
+                    if (ok)
+                        value = *cursor++;
+                }
+            };
+            byte(DIFF_A, r.post.A);
+            byte(DIFF_F, r.post.F);
+            byte(DIFF_B, r.post.B);
+            byte(DIFF_C, r.post.C);
+            byte(DIFF_D, r.post.D);
+            byte(DIFF_E, r.post.E);
+            byte(DIFF_H, r.post.H);
+            byte(DIFF_L, r.post.L);
+            if (r.changed & DIFF_SP)
+                ok = ok && getFixed(cursor, payloadEnd, r.post.SP);
+            uint16_t jump = 0;
+            if (r.changed & DIFF_JUMP)
+                ok = ok && getFixed(cursor, payloadEnd, jump);
+            if (r.changed & DIFF_WRITES)
+                ok = ok && getAccesses(cursor, payloadEnd, r.writes, r.writeCount, 1);
+            ok = ok && payloadEnd - cursor >= 2;
+            if (!ok)
+                break;
+            r.cycles = *cursor++;
+            r.length = *cursor++;
+            r.post.PC = (r.changed & DIFF_JUMP) ? jump : static_cast<uint16_t>(r.pre.PC + r.length);
+
+            regs = r.post;
+            lastEnd = r.cycle + r.cycles;
+            records.push_back(r);
+        }
+        ok = ok && cursor == payloadEnd;
+    }
+
+    if (!ok)
+        std::cerr << "DiffTraceReader: corrupt data in segment " << k << std::endl;
+    return ok;
+}
+
+bool DiffTraceReader::readKeyframe(size_t k, DiffKeyframe& keyframe) {
+    if (k >= index.size())
+        return false;
+
+    std::vector<uint8_t> bytes(1 + 8 + 8 + 12 + Memory::MEMORY_SIZE);
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(index[k].offset));
+    file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file || bytes[0] != CHUNK_KEYFRAME) {
+        std::cerr << "DiffTraceReader: error reading keyframe " << k << std::endl;
+        return false;
+    }
+
+    const uint8_t* cursor = bytes.data() + 1;
+    const uint8_t* end = bytes.data() + bytes.size();
+    getFixed(cursor, end, keyframe.record);
+    getFixed(cursor, end, keyframe.cycle);
+    getRegisters(cursor, end, keyframe.registers);
+    keyframe.memory.assign(cursor, end);
+    return true;
+}
@@ -0,0 +1,136 @@
+#ifndef DIFFTRACE_H
+#define DIFFTRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "TraceWriter.h"
+#include "memory/Memory.h"
+
+// State-diff trace file format ("GBDIFF01"), all fields little-endian:
+//
+//   header     magic[8] "GBDIFF01", u32 keyframe interval, u32 0
+//   chunk*     u8 type followed by the chunk body
+//     keyframe (type 0): u64 record index, u64 cycle, registers (A F B C D E H L, u16 SP, u16 PC),
+//                        64 KiB memory image
+//     records  (type 1): u32 record count, u32 payload size, payload
+//   index      keyframe count x { u64 record index, u64 file offset }
+//   footer     u64 index offset, u32 keyframe count, magic[4] "GBDX"
+//
+// Each record in a payload starts with a varint mask of DiffField bits and
+// carries only what changed:
+//   PreState  : registers (12 bytes) when the pre-state is not the previous post-state
+//   CycleGap  : varint cycles between the previous instruction's end and this start
+//   Inputs    : u8 count, count x { u16 address, u8 value } bytes the CPU read that
+//               differ from the recorded memory (I/O registers, devices)
+//   A..L      : new register values, one byte each, in field order
+//   SP        : u16 new SP
+//   Jump      : u16 new PC when it is not the next sequential instruction
+//   Writes    : u8 count, count x { u16 address, u8 value }
+//   then u8 instruction cycles and u8 instruction length (opcode + operands).
+// An interrupt dispatch fetches nothing and is stored with length 0; its
+// Jump is the vector and its Writes the IF acknowledge and the pushed PC.
+//
+// Memory is the keyframe image with inputs and writes applied in order, so a
+// replay from any keyframe reproduces exactly what the CPU saw.
+enum DiffField : uint32_t {
+    DIFF_A = 1 << 0,
+    DIFF_F = 1 << 1,
+    DIFF_B = 1 << 2,
+    DIFF_C = 1 << 3,
+    DIFF_D = 1 << 4,
+    DIFF_E = 1 << 5,
+    DIFF_H = 1 << 6,
+    DIFF_L = 1 << 7,
+    DIFF_SP = 1 << 8,
+    DIFF_JUMP = 1 << 9,
+    DIFF_WRITES = 1 << 10,
+    DIFF_INPUTS = 1 << 11,
+    DIFF_PRESTATE = 1 << 12,
+    DIFF_CYCLEGAP = 1 << 13
+};
+
+// Full machine state at a record boundary
+struct DiffKeyframe {
+    uint64_t record;
+    uint64_t cycle;
+    RegisterSnapshot registers;
+    std::vector<uint8_t> memory;  // Memory::MEMORY_SIZE bytes
+};
+
+// One decoded instruction
+struct DiffRecord {
+    uint32_t changed;            // DiffField mask
+    uint64_t cycle;
+    RegisterSnapshot pre;
+    RegisterSnapshot post;
+    MemoryAccess inputs[TraceRecord::MAX_MEM_ACCESSES];
+    MemoryAccess writes[TraceRecord::MAX_MEM_ACCESSES];
+    uint8_t inputCount;
+    uint8_t writeCount;
+    uint8_t cycles;
+    uint8_t length;              // 0 for an interrupt dispatch
+};
+
+struct DiffIndexEntry {
+    uint64_t record;
+    uint64_t offset;
+};
+
+// TraceWriter that stores only changed registers and bytes, with periodic
+// full keyframes for random access
+class DiffTraceWriter : public TraceWriter {
+public:
+    static constexpr uint32_t DEFAULT_KEYFRAME_INTERVAL = 1 << 16;
+
+    explicit DiffTraceWriter(const TraceWriterOptions& options = TraceWriterOptions(),
+                             uint32_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+    ~DiffTraceWriter() override;
+
+    // Open the file with the memory contents the first traced instruction will see.
+    // Call on the CPU thread before attaching the CPU trace.
+    bool open(const std::string& filename, const Memory& initialMemory);
+
+protected:
+    void writeHeader() override;
+    void writeRecords(const TraceRecord* records, size_t count) override;
+    void writeTrailer() override;
+
+private:
+    void writeKeyframe(const TraceRecord& next);
+    void encode(const TraceRecord& r, std::vector<uint8_t>& out);
+
+    uint32_t interval;
+    std::vector<uint8_t> shadow;     // Memory as the CPU sees it
+    RegisterSnapshot registers{};    // Post-state of the previous record
+    uint64_t lastEnd = 0;            // Cycle the previous record ended at
+    uint64_t nextRecord = 0;
+    std::vector<DiffIndexEntry> index;
+    std::vector<uint8_t> payload;
+};
+
+// Sequential/random-access reader for state-diff traces
+class DiffTraceReader {
+public:
+    bool open(const std::string& filename);
+
+    const std::vector<DiffIndexEntry>& keyframes() const { return index; }
+    uint64_t recordCount() const { return totalRecords; }
+
+    // Decode the segment starting at keyframe `k` (up to the next keyframe).
+    // `memory` in the keyframe is the state before the first record.
+    bool readSegment(size_t k, DiffKeyframe& keyframe, std::vector<DiffRecord>& records);
+
+    // Read only the keyframe of segment `k`
+    bool readKeyframe(size_t k, DiffKeyframe& keyframe);
+
+private:
+    std::ifstream file;
+    std::vector<DiffIndexEntry> index;
+    uint64_t totalRecords = 0;
+    uint64_t dataEnd = 0;
+};
+
+#endif // DIFFTRACE_H
@@ -0,0 +1,71 @@
+#ifndef TRACEENCODING_H
+#define TRACEENCODING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Byte-level helpers shared by the trace file formats. Readers take a cursor
+// and an end pointer and return false instead of running past the end.
+
+inline uint64_t zigzagEncode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// LEB128 unsigned varint
+inline void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline bool getVarint(const uint8_t*& cursor, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+        uint8_t byte = *cursor++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+// Signed delta against the previous value of the same stream
+inline void putDelta(std::vector<uint8_t>& out, uint64_t value, uint64_t& previous) {
+    putVarint(out, zigzagEncode(static_cast<int64_t>(value - previous)));
+    previous = value;
+}
+
+inline bool getDelta(const uint8_t*& cursor, const uint8_t* end, uint64_t& previous) {
+    uint64_t raw;
+    if (!getVarint(cursor, end, raw))
+        return false;
+    previous += static_cast<uint64_t>(zigzagDecode(raw));
+    return true;
+}
+
+// Fixed-size little-endian fields (the formats are defined little-endian)
+template <typename T>
+inline void putFixed(std::vector<uint8_t>& out, T value) {
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+inline bool getFixed(const uint8_t*& cursor, const uint8_t* end, T& value) {
+    if (static_cast<size_t>(end - cursor) < sizeof(T))
+        return false;
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return true;
+}
+
+#endif // TRACEENCODING_H
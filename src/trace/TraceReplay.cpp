@@ -0,0 +1,285 @@
+#include "TraceReplay.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "cpu/CPU.h"
+
+namespace {
+
+// A fresh CPU and memory seeded from a keyframe
+struct ReplayMachine {
+    Memory memory;
+    CPURegisters registers;
+    CPU cpu{&memory, &registers};
+
+    void seed(const DiffKeyframe& keyframe) {
+        memory.loadState(keyframe.memory.data());
+        restoreRegisters(registers, keyframe.registers);
+        CPUState state = cpu.saveState();
+        state.cycles = keyframe.cycle;
+        state.halted = false;
+        cpu.loadState(state);
+    }
+
+    // Execute one recorded instruction with the recorded inputs in place
+    void execute(const DiffRecord& r) {
+        if (r.changed & DIFF_PRESTATE)
+            restoreRegisters(registers, r.pre);
+        // Every record runs the CPU: a HALT before it was woken by an
+        // interrupt, so leave the halted state
+        if (cpu.getCycles() != r.cycle || cpu.isHalted()) {
+            CPUState state = cpu.saveState();
+            state.cycles = r.cycle;
+            state.halted = false;
+            cpu.loadState(state);
+        }
+        for (int i = 0; i < r.inputCount; i++)
+            memory.writeByte(r.inputs[i].address, r.inputs[i].value);
+        if (r.length != 0) {
+            cpu.step();
+            return;
+        }
+        // Interrupt dispatch: which one is only known from the vector. A jump
+        // anywhere else is left undone for compare() to report.
+        uint16_t vector = r.post.PC;
+        if (vector >= 0x40 && vector <= 0x60 && (vector & 7) == 0)
+            cpu.dispatchInterrupt(static_cast<uint8_t>((vector - 0x40) >> 3));
+    }
+
+    // DiffField bits of the post-state that differ from the record
+    uint32_t compare(const DiffRecord& r, RegisterSnapshot& actual) {
+        captureRegisters(registers, actual);
+        uint32_t fields = 0;
+        const uint8_t* got = &actual.A;
+        const uint8_t* want = &r.post.A;
+        for (int i = 0; i < 8; i++)
+            if (got[i] != want[i])
+                fields |= 1u << i;
+        if (actual.SP != r.post.SP)
+            fields |= DIFF_SP;
+        if (actual.PC != r.post.PC)
+            fields |= DIFF_JUMP;
+        if (cpu.getCycles() - r.cycle != r.cycles)
+            fields |= DIFF_CYCLEGAP;
+        for (int i = 0; i < r.writeCount; i++) {
+            // Only the last write to an address is visible afterwards
+            bool overwritten = false;
+            for (int j = i + 1; j < r.writeCount; j++)
+                overwritten |= r.writes[j].address == r.writes[i].address;
+            if (!overwritten && memory.readByte(r.writes[i].address) != r.writes[i].value)
+                fields |= DIFF_WRITES;
+        }
+        return fields;
+    }
+};
+
+// Memory as recorded after the first `n` records of a segment
+void recordedMemory(const DiffKeyframe& keyframe, const std::vector<DiffRecord>& records,
+                    size_t n, std::vector<uint8_t>& out) {
+    out = keyframe.memory;
+    for (size_t i = 0; i < n; i++) {
+        const DiffRecord& r = records[i];
+        for (int j = 0; j < r.inputCount; j++)
+            out[r.inputs[j].address] = r.inputs[j].value;
+        for (int j = 0; j < r.writeCount; j++)
+            out[r.writes[j].address] = r.writes[j].value;
+    }
+}
+
+// First address where the machine's memory differs from `image`, or -1
+long firstDifference(const ReplayMachine& machine, const std::vector<uint8_t>& image) {
+    for (size_t address = 0; address < Memory::MEMORY_SIZE; address++)
+        if (machine.memory.readByte(static_cast<uint16_t>(address)) != image[address])
+            return static_cast<long>(address);
+    return -1;
+}
+
+} // namespace
+
+TraceReplayer::TraceReplayer(const ReplayOptions& options) : options(options) {
+}
+
+bool TraceReplayer::replaySegment(DiffTraceReader& reader, size_t k, uint64_t& verified,
+                                  bool& found, ReplayDivergence& divergence) {
+    DiffKeyframe keyframe;
+    std::vector<DiffRecord> records;
+    if (!reader.readSegment(k, keyframe, records))
+        return false;
+
+    auto machine = std::make_unique<ReplayMachine>();
+    machine->seed(keyframe);
+
+    found = false;
+    for (size_t i = 0; i < records.size(); i++) {
+        const DiffRecord& r = records[i];
+        machine->execute(r);
+        RegisterSnapshot actual;
+        uint32_t fields = machine->compare(r, actual);
+        if (fields) {
+            found = true;
+            divergence.record = keyframe.record + i;
+            divergence.fields = fields;
+            divergence.expected = r;
+            divergence.actual = actual;
+            divergence.actualCycles = machine->cpu.getCycles() - r.cycle;
+            divergence.address = 0;
+            for (int j = 0; j < r.writeCount; j++)
+                if (machine->memory.readByte(r.writes[j].address) != r.writes[j].value) {
+                    divergence.address = r.writes[j].address;
+                    break;
+                }
+            return true;
+        }
+        verified++;
+    }
+
+    if (!options.checkKeyframes || k + 1 >= reader.keyframes().size())
+        return true;
+
+    // Every recorded field matched, but a write the trace does not know about
+    // shows up in the next keyframe. Bisect for the first record after which
+    // replayed and recorded memory disagree.
+    DiffKeyframe next;
+    if (!reader.readKeyframe(k + 1, next))
+        return false;
+    if (firstDifference(*machine, next.memory) < 0)
+        return true;
+
+    std::vector<uint8_t> image;
+    recordedMemory(keyframe, records, records.size(), image);
+    if (firstDifference(*machine, image) < 0) {
+        std::cerr << "TraceReplayer: keyframe " << k + 1 << " does not match the records before it" << std::endl;
+        return false;
+    }
+
+    size_t good = 0, bad = records.size();
+    while (bad - good > 1) {
+        size_t mid = good + (bad - good) / 2;
+        machine->seed(keyframe);
+        for (size_t i = 0; i < mid; i++)
+            machine->execute(records[i]);
+        recordedMemory(keyframe, records, mid, image);
+        if (firstDifference(*machine, image) < 0)
+            good = mid;
+        else
+            bad = mid;
+    }
+
+    machine->seed(keyframe);
+    for (size_t i = 0; i < bad; i++)
+        machine->execute(records[i]);
+    recordedMemory(keyframe, records, bad, image);
+
+    const DiffRecord& r = records[bad - 1];
+    found = true;
+    divergence.record = keyframe.record + bad - 1;
+    divergence.fields = DIFF_WRITES;
+    divergence.expected = r;
+    captureRegisters(machine->registers, divergence.actual);
+    divergence.actualCycles = machine->cpu.getCycles() - r.cycle;
+    divergence.address = static_cast<uint16_t>(firstDifference(*machine, image));
+    verified = bad - 1;
+    return true;
+}
+
+ReplayResult TraceReplayer::run(const std::string& filename) {
+    ReplayResult result;
+
+    DiffTraceReader reader;
+    if (!reader.open(filename))
+        return result;
+    result.segments = reader.keyframes().size();
+
+    unsigned threads = options.threads ? options.threads : std::thread::hardware_concurrency();
+    threads = static_cast<unsigned>(std::min<size_t>(std::max(threads, 1u), std::max<size_t>(result.segments, 1)));
+
+    // Segments are handed out in order, so once a divergence is known only
+    // earlier segments are still worth replaying
+    std::atomic<size_t> nextSegment{0};
+    std::atomic<uint64_t> firstBad{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> verified{0};
+    std::atomic<bool> failed{false};
+    std::mutex lock;
+
+    auto worker = [&](DiffTraceReader& segmentReader) {
+        for (;;) {
+            size_t k = nextSegment++;
+            if (k >= result.segments || failed)
+                return;
+            if (segmentReader.keyframes()[k].record >= firstBad)
+                return;
+
+            uint64_t count = 0;
+            bool found = false;
+            ReplayDivergence divergence;
+            if (!replaySegment(segmentReader, k, count, found, divergence)) {
+                failed = true;
+                return;
+            }
+            verified += count;
+            if (found) {
+                std::lock_guard<std::mutex> guard(lock);
+                if (divergence.record < firstBad) {
+                    firstBad = divergence.record;
+                    result.divergence = divergence;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    std::vector<std::unique_ptr<DiffTraceReader>> readers;
+    for (unsigned t = 1; t < threads; t++) {
+        auto extra = std::make_unique<DiffTraceReader>();
+        if (!extra->open(filename))
+            return result;
+        readers.push_back(std::move(extra));
+    }
+    for (auto& extra : readers)
+        pool.emplace_back(worker, std::ref(*extra));
+    worker(reader);
+    for (auto& thread : pool)
+        thread.join();
+
+    result.recordsVerified = verified;
+    result.diverged = firstBad != std::numeric_limits<uint64_t>::max();
+    result.ok = !failed && !result.diverged;
+    return result;
+}
+
+void TraceReplayer::describe(const ReplayDivergence& divergence, std::ostream& out) {
+    static const char* names[8] = {"A", "F", "B", "C", "D", "E", "H", "L"};
+    const DiffRecord& r = divergence.expected;
+    const uint8_t* want = &r.post.A;
+    const uint8_t* got = &divergence.actual.A;
+
+    std::ios::fmtflags flags = out.flags();
+    char fill = out.fill();
+    out << std::hex << std::uppercase << std::setfill('0');
+    out << "Divergence at record " << std::dec << divergence.record << " (cycle " << r.cycle
+        << "), PC=0x" << std::hex << std::setw(4) << r.pre.PC << std::endl;
+    for (int i = 0; i < 8; i++)
+        if (divergence.fields & (1u << i))
+            out << "  " << names[i] << ": expected 0x" << std::setw(2) << int(want[i])
+                << ", got 0x" << std::setw(2) << int(got[i]) << std::endl;
+    if (divergence.fields & DIFF_SP)
+        out << "  SP: expected 0x" << std::setw(4) << r.post.SP
+            << ", got 0x" << std::setw(4) << divergence.actual.SP << std::endl;
+    if (divergence.fields & DIFF_JUMP)
+        out << "  PC: expected 0x" << std::setw(4) << r.post.PC
+            << ", got 0x" << std::setw(4) << divergence.actual.PC << std::endl;
+    if (divergence.fields & DIFF_CYCLEGAP)
+        out << "  cycles: expected " << std::dec << int(r.cycles)
+            << ", got " << divergence.actualCycles << std::hex << std::endl;
+    if (divergence.fields & DIFF_WRITES)
+        out << "  memory differs at 0x" << std::setw(4) << divergence.address << std::endl;
+    out.flags(flags);
+    out.fill(fill);
+}
@@ -0,0 +1,54 @@
+#ifndef TRACEREPLAY_H
+#define TRACEREPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include "DiffTrace.h"
+
+struct ReplayOptions {
+    unsigned threads = 0;         // Worker threads, 0 = hardware concurrency
+    bool checkKeyframes = true;   // Compare memory with the next keyframe at segment ends
+};
+
+// First instruction whose re-execution does not match the trace
+struct ReplayDivergence {
+    uint64_t record;              // Index of the instruction in the trace
+    uint32_t fields;              // DiffField bits that differ (DIFF_JUMP = PC, DIFF_CYCLEGAP = cycles)
+    DiffRecord expected;          // As recorded
+    RegisterSnapshot actual;      // Post-state after re-execution
+    uint64_t actualCycles;        // Instruction cycles after re-execution
+    uint16_t address;             // First differing memory byte when DIFF_WRITES is set
+};
+
+struct ReplayResult {
+    bool ok = false;              // Trace could be read and no divergence was found
+    bool diverged = false;
+    uint64_t recordsVerified = 0;
+    size_t segments = 0;
+    ReplayDivergence divergence{};
+};
+
+// Re-executes a state-diff trace on fresh CPU/Memory instances and verifies
+// every recorded post-state. Segments are replayed in parallel, each seeded
+// from its keyframe; the recorded inputs stand in for the devices.
+class TraceReplayer {
+public:
+    explicit TraceReplayer(const ReplayOptions& options = ReplayOptions());
+
+    ReplayResult run(const std::string& filename);
+
+    // Print a divergence as a register/field comparison
+    static void describe(const ReplayDivergence& divergence, std::ostream& out);
+
+private:
+    // Replay one segment, stopping at the first mismatch. Returns false on
+    // read errors; `found` is set when a divergence was located.
+    bool replaySegment(DiffTraceReader& reader, size_t k, uint64_t& verified,
+                       bool& found, ReplayDivergence& divergence);
+
+    ReplayOptions options;
+};
+
+#endif // TRACEREPLAY_H
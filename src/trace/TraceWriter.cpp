@@ -0,0 +1,273 @@
+#include "TraceWriter.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <unistd.h>
+
+// O_DIRECT needs block-aligned buffers, offsets and sizes
+static constexpr size_t DIRECT_ALIGN = 4096;
+static constexpr size_t STAGING_SIZE = 1 << 22;  // 4 MiB per write
+
+// Raw trace file header
+struct RawTraceHeader {
+    char magic[8];        // "GBTRACE1"
+    uint32_t recordSize;  // sizeof(TraceRecord)
+    uint32_t reserved;
+};
+
+TraceWriter::TraceWriter(const TraceWriterOptions& opts) : options(opts) {
+    if (options.bufferRecords == 0)
+        options.bufferRecords = 1;
+    if (options.sampleEvery < 2)
+        options.sampleEvery = 2;
+    buffers[0].reset(new TraceRecord[options.bufferRecords]);
+    buffers[1].reset(new TraceRecord[options.bufferRecords]);
+}
+
+TraceWriter::~TraceWriter() {
+    // Subclass trailers were written by the subclass destructor already
+    close();
+}
+
+bool TraceWriter::open(const std::string& filename) {
+    close();
+
+    int flags = O_WRONLY | O_CREAT | O_TRUNC;
+    direct = false;
+#ifdef O_DIRECT
+    if (options.directIO) {
+        fd = ::open(filename.c_str(), flags | O_DIRECT, 0644);
+        if (fd >= 0)
+            direct = true;
+        else
+            std::cerr << "TraceWriter::open O_DIRECT unavailable for " << filename
+                      << ", using buffered writes" << std::endl;
+    }
+#endif
+    if (fd < 0)
+        fd = ::open(filename.c_str(), flags, 0644);
+    if (fd < 0) {
+        std::cerr << "TraceWriter::open failed to open " << filename << ": "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (direct) {
+        staging = static_cast<uint8_t*>(std::aligned_alloc(DIRECT_ALIGN, STAGING_SIZE));
+        stagingUsed = 0;
+        if (!staging) {
+            std::cerr << "TraceWriter::open failed to allocate the O_DIRECT staging buffer" << std::endl;
+            ::close(fd);
+            fd = -1;
+            direct = false;
+            return false;
+        }
+    }
+
+    written = 0;
+    fileBytes = 0;
+    failed = false;
+    dropped = 0;
+    sampledOut = 0;
+    sampled = 0;
+    stopping = false;
+    writeHeader();
+    thread = std::thread(&TraceWriter::writerLoop, this);
+    return true;
+}
+
+bool TraceWriter::close() {
+    if (fd < 0)
+        return !failed;
+
+    // The trace must not keep handing buffers to a closed (or destroyed) writer
+    if (source)
+        source->detach();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (thread.joinable())
+        thread.join();
+
+    writeTrailer();
+    flushStaging(true);
+    ::close(fd);
+    fd = -1;
+    std::free(staging);
+    staging = nullptr;
+    if (failed)
+        std::cerr << "TraceWriter::close: the trace is incomplete after a failed write ("
+                  << fileBytes.load() << " bytes written)" << std::endl;
+    return !failed;
+}
+
+void TraceWriter::attach(BufferTrace& trace) {
+    trace.attach(this, buffers[0].get(), options.bufferRecords);
+    source = &trace;
+}
+
+void TraceWriter::detached(BufferTrace* trace) {
+    if (trace == source)
+        source = nullptr;
+}
+
+TraceRecord* TraceWriter::flush(TraceRecord* records, size_t& count, bool wait) {
+    if (count == 0)
+        return records;
+
+    if (busy.load(std::memory_order_acquire)) {
+        // The writer has not finished the other buffer yet
+        Backpressure policy = wait ? Backpressure::Block : options.backpressure;
+        switch (policy) {
+            case Backpressure::Block:
+                waitIdle();
+                break;
+            case Backpressure::Drop:
+                dropped += count;
+                count = 0;
+                sampled = 0;
+                return records;
+            case Backpressure::Sample: {
+                // Records before `sampled` were kept by an earlier pass; only
+                // thin out the ones appended since
+                size_t kept = sampled;
+                for (size_t i = sampled; i < count; i += options.sampleEvery)
+                    records[kept++] = records[i];
+                if (kept < count) {
+                    sampledOut += count - kept;
+                    count = kept;
+                    sampled = kept;
+                    return records;
+                }
+                // Nothing left to thin out
+                waitIdle();
+                break;
+            }
+        }
+    }
+
+    handOff(records, count);
+    count = 0;
+    sampled = 0;
+    return records == buffers[0].get() ? buffers[1].get() : buffers[0].get();
+}
+
+void TraceWriter::handOff(TraceRecord* records, size_t count) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending = records;
+        pendingCount = count;
+        busy.store(true, std::memory_order_release);
+    }
+    wake.notify_one();
+}
+
+void TraceWriter::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return !busy.load(std::memory_order_acquire); });
+}
+
+void TraceWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this] { return pending != nullptr || stopping; });
+        if (pending == nullptr)
+            break;  // Stopping with nothing left to write
+
+        TraceRecord* records = pending;
+        size_t count = pendingCount;
+        lock.unlock();
+
+        writeRecords(records, count);
+        if (!failed)
+            written.fetch_add(count, std::memory_order_relaxed);
+
+        lock.lock();
+        pending = nullptr;
+        busy.store(false, std::memory_order_release);
+        done.notify_all();
+    }
+}
+
+void TraceWriter::writeHeader() {
+    RawTraceHeader header{};
+    std::memcpy(header.magic, "GBTRACE1", 8);
+    header.recordSize = sizeof(TraceRecord);
+    writeBytes(&header, sizeof(header));
+}
+
+void TraceWriter::writeRecords(const TraceRecord* records, size_t count) {
+    writeBytes(records, count * sizeof(TraceRecord));
+}
+
+void TraceWriter::writeBytes(const void* bytes, size_t size) {
+    // Later bytes would land at the wrong offset
+    if (failed)
+        return;
+    const uint8_t* src = static_cast<const uint8_t*>(bytes);
+
+    if (!direct) {
+        while (size > 0) {
+            ssize_t n = ::write(fd, src, size);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                writeFailed();
+                return;
+            }
+            fileBytes.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+            src += n;
+            size -= static_cast<size_t>(n);
+        }
+        return;
+    }
+
+    // Staged bytes count as written; a failed flush takes them back off
+    while (size > 0 && !failed) {
+        size_t chunk = std::min(size, STAGING_SIZE - stagingUsed);
+        std::memcpy(staging + stagingUsed, src, chunk);
+        stagingUsed += chunk;
+        fileBytes.fetch_add(chunk, std::memory_order_relaxed);
+        src += chunk;
+        size -= chunk;
+        if (stagingUsed == STAGING_SIZE)
+            flushStaging(false);
+    }
+}
+
+void TraceWriter::writeFailed() {
+    std::cerr << "TraceWriter write failed: " << std::strerror(errno) << std::endl;
+    failed = true;
+}
+
+void TraceWriter::flushStaging(bool final) {
+    if (!direct || stagingUsed == 0)
+        return;
+
+    // The last block is padded to the alignment and the file truncated afterwards
+    size_t size = final ? (stagingUsed + DIRECT_ALIGN - 1) & ~(DIRECT_ALIGN - 1) : stagingUsed;
+    std::memset(staging + stagingUsed, 0, size - stagingUsed);
+
+    size_t offset = 0;
+    while (offset < size) {
+        ssize_t n = ::write(fd, staging + offset, size - offset);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            writeFailed();
+            fileBytes.fetch_sub(stagingUsed - std::min(offset, stagingUsed), std::memory_order_relaxed);
+            break;
+        }
+        offset += static_cast<size_t>(n);
+    }
+    stagingUsed = 0;
+
+    if (final && ftruncate(fd, static_cast<off_t>(fileBytes.load())) != 0)
+        std::cerr << "TraceWriter failed to trim padding: " << std::strerror(errno) << std::endl;
+}
@@ -0,0 +1,111 @@
+#ifndef TRACEWRITER_H
+#define TRACEWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "TracePolicy.h"
+
+// What the CPU thread does with a full buffer while the writer is still busy
+enum class Backpressure {
+    Block,   // Wait for the writer (lossless)
+    Drop,    // Discard the full buffer
+    Sample   // Keep every Nth record in place and keep filling
+};
+
+struct TraceWriterOptions {
+    size_t bufferRecords = 1 << 16;  // Records per buffer (two buffers are used)
+    Backpressure backpressure = Backpressure::Block;
+    unsigned sampleEvery = 8;        // Decimation factor for Backpressure::Sample
+    bool directIO = false;           // Open with O_DIRECT (falls back to buffered I/O)
+};
+
+// Asynchronous trace sink. The CPU thread fills one buffer through
+// BufferTrace while a background thread writes the other one to disk with
+// large sequential writes. Handing a buffer over is a pointer swap; the CPU
+// thread never touches the file.
+//
+// Usage:
+//   TraceWriter writer;
+//   writer.open("run.trace");
+//   writer.attach(cpu.tracer());
+//   ... run ...
+//   writer.close();  // Also detaches the CPU trace
+class TraceWriter : public TraceSink {
+public:
+    explicit TraceWriter(const TraceWriterOptions& options = TraceWriterOptions());
+    // Closes an open writer, but without reaching subclass overrides
+    ~TraceWriter() override;
+
+    // Create the output file and start the writer thread
+    bool open(const std::string& filename);
+
+    // Detach the attached trace (flushing it), wait for pending data, write
+    // the tail and stop the writer thread. False if a write failed, in which
+    // case the file ends at the last byte that was written.
+    bool close();
+
+    // Point a CPU trace buffer at this writer until either side detaches
+    void attach(BufferTrace& trace);
+
+    TraceRecord* flush(TraceRecord* records, size_t& count, bool wait) override;
+    void detached(BufferTrace* trace) override;
+
+    uint64_t recordsWritten() const { return written.load(std::memory_order_relaxed); }
+    uint64_t recordsDropped() const { return dropped; }
+    uint64_t recordsSampledOut() const { return sampledOut; }
+    uint64_t bytesWritten() const { return fileBytes.load(std::memory_order_relaxed); }
+
+protected:
+    // Serialize a block of records to the output stream. The default writes
+    // raw TraceRecords after a small file header.
+    virtual void writeHeader();
+    virtual void writeRecords(const TraceRecord* records, size_t count);
+    // Subclasses that write a trailer must call close() in their own
+    // destructor, since the base destructor only reaches this version.
+    virtual void writeTrailer() {}
+
+    // Append bytes to the file (called on the writer thread). After a failed
+    // write nothing more is written and bytesWritten() stays at what reached the file.
+    void writeBytes(const void* bytes, size_t size);
+
+private:
+    void writerLoop();
+    void handOff(TraceRecord* records, size_t count);
+    void waitIdle();
+    void flushStaging(bool final);
+    void writeFailed();
+
+    TraceWriterOptions options;
+    BufferTrace* source = nullptr;  // Trace attached to this writer (CPU thread)
+    std::unique_ptr<TraceRecord[]> buffers[2];
+    int fd = -1;
+    bool direct = false;
+    bool failed = false;  // A write failed (latched until the next open)
+
+    // Staging area for O_DIRECT (aligned, written in whole blocks)
+    uint8_t* staging = nullptr;
+    size_t stagingUsed = 0;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    TraceRecord* pending = nullptr;
+    size_t pendingCount = 0;
+    bool stopping = false;
+    std::atomic<bool> busy{false};
+
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> fileBytes{0};
+    uint64_t dropped = 0;
+    uint64_t sampledOut = 0;
+    size_t sampled = 0;  // Leading records of the CPU's buffer already sampled (CPU thread)
+};
+
+#endif // TRACEWRITER_H
@@ -0,0 +1,253 @@
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ipc/SharedChannel.h"
+
+// Run the gb_server side of a SharedChannel in this process against trainers
+// forked from it: create -> open -> call(Reset/Step) -> respond, a server
+// error status, a second trainer refused while one is live, trainers killed
+// mid-session whose slot is reclaimed, and a segment left by a dead server
+// that trainers cannot use and create() replaces.
+//   channel_check
+
+namespace {
+
+constexpr uint32_t ENVS = 4;
+constexpr uint32_t WIDTH = 8;
+constexpr uint32_t HEIGHT = 4;
+constexpr uint32_t STACK = 2;
+
+// Actions the fake server refuses, to exercise the error status
+constexpr uint8_t BAD_ACTION = 0xFF;
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if (!ok && failures++ < 20)
+        std::printf("FAIL (pid %d): %s\n", static_cast<int>(getpid()), what);
+}
+
+// What the fake environment puts in the arrays, so the trainer can tell
+// its request was run
+uint8_t resetPixel(uint32_t instance, uint32_t offset) {
+    return static_cast<uint8_t>(instance * 31 + offset);
+}
+uint8_t stepAction(int step, uint32_t instance) {
+    return static_cast<uint8_t>((step * 3 + instance) % BAD_ACTION);
+}
+float stepReward(uint32_t instance, uint8_t action) {
+    return static_cast<float>(action) + 0.25f * instance;
+}
+
+using Child = void (*)(const std::string& name);
+
+// Fork a process that runs `child` on the channel `name`; it exits 0 when
+// all its checks passed. _exit() keeps it from running this process's
+// destructors, which would unlink the server's segment.
+pid_t spawn(Child child, const std::string& name) {
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        failures = 0;
+        child(name);
+        std::fflush(stdout);
+        _exit(failures ? 1 : 0);
+    }
+    return pid;
+}
+
+// Reap `pid` and return its wait status
+int finish(pid_t pid) {
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    return status;
+}
+
+// Answer `trainer`'s requests the way gb_server does until it exits, and
+// return its wait status. While a trainer is attached nobody else may open
+// the channel.
+int serve(SharedChannel& channel, pid_t trainer, const std::string& name) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    uint32_t served = channel.info().request.load();
+    for (;;) {
+        uint32_t request;
+        if (!channel.waitRequest(served, request, 10)) {
+            int status = 0;
+            if (waitpid(trainer, &status, WNOHANG) == trainer)
+                return status;
+            if (std::chrono::steady_clock::now() > deadline) {
+                check(false, "trainer timed out");
+                kill(trainer, SIGKILL);
+                return finish(trainer);
+            }
+            continue;
+        }
+        served = request;
+
+        bool ok = true;
+        const uint32_t bytes = channel.info().observationBytes;
+        switch (channel.info().command) {
+            case ChannelCommand::Reset: {
+                check(channel.info().trainerPid.load() == trainer, "trainer pid not recorded on open");
+                SharedChannel intruder;
+                check(!intruder.open(name), "second trainer attached while the first is live");
+                for (uint32_t i = 0; i < channel.envs(); i++)
+                    for (uint32_t k = 0; k < bytes; k++)
+                        channel.observations()[i * bytes + k] = resetPixel(i, k);
+                break;
+            }
+            case ChannelCommand::Step:
+                for (uint32_t i = 0; i < channel.envs(); i++) {
+                    uint8_t action = channel.actions()[i];
+                    ok = ok && action != BAD_ACTION;
+                    channel.observations()[i * bytes] = action;
+                    channel.rewards()[i] = stepReward(i, action);
+                    channel.dones()[i] = action & 1;
+                }
+                break;
+            default:
+                ok = false;
+                break;
+        }
+        channel.respond(request, ok ? 0 : 1);
+    }
+}
+
+bool exitedCleanly(int status) {
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/////////////////////////  Children  ////////////////////////////////
+
+bool resetAndStep(SharedChannel& channel) {
+    if (!channel.call(ChannelCommand::Reset))
+        return false;
+    const uint32_t bytes = channel.info().observationBytes;
+    bool filled = true;
+    for (uint32_t i = 0; i < channel.envs(); i++)
+        for (uint32_t k = 0; k < bytes; k++)
+            filled = filled && channel.observations()[i * bytes + k] == resetPixel(i, k);
+    check(filled, "observations after Reset");
+
+    for (int step = 0; step < 100; step++) {
+        for (uint32_t i = 0; i < channel.envs(); i++)
+            channel.actions()[i] = stepAction(step, i);
+        if (!channel.call(ChannelCommand::Step))
+            return false;
+        bool matched = true;
+        for (uint32_t i = 0; i < channel.envs(); i++) {
+            uint8_t action = stepAction(step, i);
+            matched = matched && channel.observations()[i * bytes] == action &&
+                      channel.rewards()[i] == stepReward(i, action) && channel.dones()[i] == (action & 1);
+        }
+        check(matched, "observations, rewards and dones after Step");
+    }
+    return true;
+}
+
+void wellBehaved(const std::string& name) {
+    SharedChannel channel;
+    if (!channel.open(name)) {
+        check(false, "open a published channel");
+        return;
+    }
+    check(channel.envs() == ENVS && channel.info().observationBytes == WIDTH * HEIGHT * STACK,
+          "layout read from the header");
+    check(resetAndStep(channel), "Reset and Step calls");
+
+    // An error status fails the call without breaking the exchange
+    channel.actions()[1] = BAD_ACTION;
+    check(!channel.call(ChannelCommand::Step), "server error reported to the caller");
+    channel.actions()[1] = 0;
+    check(channel.call(ChannelCommand::Step), "Step after an error");
+    channel.close();
+}
+
+void crashing(const std::string& name) {
+    SharedChannel channel;
+    check(channel.open(name), "open a channel");
+    check(channel.call(ChannelCommand::Reset), "Reset before crashing");
+    std::fflush(stdout);
+    raise(SIGKILL);
+}
+
+void orphaned(const std::string& name) {
+    // The segment is still published, but its server is gone
+    SharedChannel channel;
+    if (!channel.open(name)) {
+        check(false, "open a stale channel");
+        return;
+    }
+    check(!channel.call(ChannelCommand::Reset), "call on a channel whose server exited");
+}
+
+void staleServer(const std::string& name) {
+    SharedChannel channel;
+    check(channel.create(name, ENVS, WIDTH, HEIGHT, STACK), "create in the server that crashes");
+    std::fflush(stdout);
+    _exit(failures ? 1 : 0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        std::fprintf(stderr, "Usage: channel_check\n");
+        return 1;
+    }
+    const std::string name = "/gbemu-channel-check-" + std::to_string(getpid());
+
+    // A server that exits without close() leaves its segment behind. A
+    // trainer can still open it but its calls fail; the next server's
+    // create() replaces it.
+    check(exitedCleanly(finish(spawn(staleServer, name))), "crashed server");
+    check(exitedCleanly(finish(spawn(orphaned, name))), "trainer of a dead server");
+
+    SharedChannel server;
+    if (!server.create(name, ENVS, WIDTH, HEIGHT, STACK)) {
+        std::printf("Cannot create %s\n", name.c_str());
+        return 1;
+    }
+    check(server.info().serverPid == getpid() && server.info().trainerPid.load() == 0 &&
+              server.info().request.load() == 0,
+          "stale segment replaced by create()");
+
+    // Full exchange, then the slot is free again
+    check(exitedCleanly(serve(server, spawn(wellBehaved, name), name)), "well-behaved trainer");
+    check(server.info().trainerPid.load() == 0, "slot released by close()");
+
+    // A trainer killed mid-session keeps the slot until the server notices
+    pid_t crashed = spawn(crashing, name);
+    int status = serve(server, crashed, name);
+    check(WIFSIGNALED(status) && WTERMSIG(status) == SIGKILL, "trainer killed");
+    check(server.info().trainerPid.load() == crashed, "dead trainer still recorded");
+    server.releaseDeadTrainer();
+    check(server.info().trainerPid.load() == 0, "dead trainer released by the server");
+
+    // ... or until the next trainer takes it over itself
+    crashed = spawn(crashing, name);
+    serve(server, crashed, name);
+    check(server.info().trainerPid.load() == crashed, "second dead trainer still recorded");
+    check(exitedCleanly(serve(server, spawn(wellBehaved, name), name)), "trainer after a crash");
+    check(server.info().trainerPid.load() == 0, "slot released after reclaiming it");
+
+    // The server removes the segment name on close
+    server.close();
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    check(fd < 0 && errno == ENOENT, "segment removed by close()");
+    if (fd >= 0) {
+        ::close(fd);
+        shm_unlink(name.c_str());
+    }
+
+    std::printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "env/RamExpression.h"
+
+// Compile reward/done expressions and check their values against a fixed
+// address space: operator precedence, multi-byte and BCD loads, delta() state
+// across reset() and evaluate(), and the messages for malformed input,
+// including nesting deep enough to overflow the stack if it were unbounded.
+//   ramexpr_check
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (!ok && failures++ < 20)
+        std::printf("FAIL: %s\n", what.c_str());
+}
+
+void expectValue(const uint8_t* memory, const std::string& text, double expected) {
+    RamExpression expression;
+    if (!expression.compile(text)) {
+        check(false, "\"" + text + "\" did not compile");
+        return;
+    }
+    std::vector<double> state(expression.stateSize());
+    expression.reset(memory, state.data());
+    double value = expression.evaluate(memory, state.data());
+    check(value == expected, "\"" + text + "\" gave " + std::to_string(value) + ", expected " +
+                                 std::to_string(expected));
+}
+
+// compile() must fail and report `message` on std::cerr
+void expectError(const std::string& text, const std::string& message) {
+    std::ostringstream captured;
+    std::streambuf* previous = std::cerr.rdbuf(captured.rdbuf());
+    RamExpression expression;
+    bool compiled = expression.compile(text);
+    std::cerr.rdbuf(previous);
+
+    std::string shown = text.size() > 40 ? text.substr(0, 40) + "..." : text;
+    check(!compiled, "\"" + shown + "\" compiled");
+    check(expression.empty(), "\"" + shown + "\" left code behind");
+    check(captured.str().find(message) != std::string::npos,
+          "\"" + shown + "\" reported \"" + captured.str() + "\", expected \"" + message + "\"");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        std::fprintf(stderr, "Usage: ramexpr_check\n");
+        return 1;
+    }
+
+    std::vector<uint8_t> memory(0x10000, 0);
+    memory[0xC000] = 0x34;
+    memory[0xC001] = 0x12;
+    memory[0xC0A0] = 0x56;  // BCD 123456, least significant byte first
+    memory[0xC0A1] = 0x34;
+    memory[0xC0A2] = 0x12;
+    memory[0xD000] = 0x80;
+    memory[0xFFFF] = 0x07;
+
+    // Precedence and associativity
+    expectValue(memory.data(), "1 + 2 * 3", 7);
+    expectValue(memory.data(), "(1 + 2) * 3", 9);
+    expectValue(memory.data(), "10 - 4 - 3", 3);
+    expectValue(memory.data(), "-2 * 3 + 10", 4);
+    expectValue(memory.data(), "1 << 2 + 1", 8);
+    expectValue(memory.data(), "1 + 1 == 2", 1);
+    expectValue(memory.data(), "6 & 3 == 3", 0);
+    expectValue(memory.data(), "1 | 2 ^ 3 & 1", 3);
+    expectValue(memory.data(), "0 || 1 && 0", 0);
+    expectValue(memory.data(), "!0 + !5", 1);
+    expectValue(memory.data(), "7 % 4 * 2", 6);
+    expectValue(memory.data(), "5 / 0", 0);
+    expectValue(memory.data(), "min(3, max(1, 2)) + abs(-4)", 6);
+    expectValue(memory.data(), "0x1F + .5", 31.5);
+    expectValue(memory.data(), "- - -1", -1);
+
+    // Loads
+    expectValue(memory.data(), "[C000]", 0x34);
+    expectValue(memory.data(), "[C000:2]", 0x1234);
+    expectValue(memory.data(), "[FFFF:2]", 0x07 | (0x00 << 8));
+    expectValue(memory.data(), "bcd[C0A0:3]", 123456);
+    expectValue(memory.data(), "bcd[C0A0]", 56);
+    expectValue(memory.data(), "([D000] & 0x80) != 0", 1);
+
+    // delta() measures from reset() and then from the previous evaluation,
+    // with one slot per call site
+    {
+        RamExpression expression;
+        check(expression.compile("delta(bcd[C0A0:3]) + 10 * delta([C000])"), "delta expression compiled");
+        check(expression.stateSize() == 2, "two delta slots");
+        std::vector<double> state(expression.stateSize());
+        std::vector<uint8_t> ram = memory;
+        expression.reset(ram.data(), state.data());
+        check(expression.evaluate(ram.data(), state.data()) == 0, "delta right after reset");
+        ram[0xC0A0] = 0x66;
+        ram[0xC000] = 0x36;
+        check(expression.evaluate(ram.data(), state.data()) == 10 + 10 * 2, "delta after a change");
+        check(expression.evaluate(ram.data(), state.data()) == 0, "delta with no change");
+        ram[0xC0A0] = 0x56;
+        check(expression.evaluate(ram.data(), state.data()) == -10, "negative delta");
+
+        // A second instance keeps its own state
+        std::vector<double> other(expression.stateSize());
+        expression.reset(memory.data(), other.data());
+        ram[0xC000] = 0x35;
+        check(expression.evaluate(ram.data(), other.data()) == 10, "delta of a separate instance");
+    }
+
+    // Malformed input
+    expectError("", "empty expression");
+    expectError("1 + $", "unexpected '$' at 4");
+    expectError("1 +", "unexpected end");
+    expectError("(1 + 2", "expected ')'");
+    expectError("1 2", "unexpected '2'");
+    expectError("[10000]", "bad address '10000'");
+    expectError("[C000:5]", "byte count must be 1-4");
+    expectError("bcd C000", "expected '['");
+    expectError("foo(1)", "unknown name 'foo'");
+    expectError("min(1)", "expected ','");
+    expectError("12abc", "bad number '12abc'");
+
+    // Deep parentheses are fine while few values are live at once, but not
+    // when they would overflow the evaluation stack
+    std::string left = "0";
+    for (int i = 0; i < 100; i++)
+        left = "(" + left + ") + 1";
+    expectValue(memory.data(), left, 100);
+    std::string right = "0";
+    for (int i = 0; i < 100; i++)
+        right = "1 + (" + right + ")";
+    expectError(right, "expression too deeply nested");
+
+    // Nesting that would recurse thousands of frames deep
+    expectError(std::string(100000, '(') + "1" + std::string(100000, ')'), "expression too deeply nested");
+    expectError(std::string(100000, '-') + "1", "expression too deeply nested");
+    expectError(std::string(50000, '!') + std::string(50000, '('), "expression too deeply nested");
+    std::string calls;
+    for (int i = 0; i < 50000; i++)
+        calls += "abs(";
+    expectError(calls, "expression too deeply nested");
+
+    std::printf("%d failures\n", failures);
+    return failures ? 1 : 0;
+}
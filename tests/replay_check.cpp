@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "gameboy/GameBoy.h"
+#include "trace/DiffTrace.h"
+#include "trace/TraceReplay.h"
+
+// Record a state-diff trace of each ROM and replay it; any divergence fails.
+// The built-in ROM sleeps in HALT until VBlank, which the test ROMs rarely do.
+//   replay_check [--steps N] [rom.gb ...]
+
+namespace {
+
+// EI; HALT loop woken by the VBlank interrupt, handler is a bare RETI
+std::vector<uint8_t> haltRom() {
+    std::vector<uint8_t> rom(0x8000, 0x00);
+    rom[0x40] = 0xD9;                                          // RETI
+    const uint8_t entry[] = {0x00, 0xC3, 0x50, 0x01};          // NOP; JP 0x0150
+    const uint8_t code[] = {0x3E, 0x01, 0xE0, 0xFF,            // LD A,1; LDH (IE),A
+                            0xFB,                              // EI
+                            0x76, 0x00, 0x18, 0xFC};           // HALT; NOP; JR -4
+    std::copy(std::begin(entry), std::end(entry), rom.begin() + 0x100);
+    std::copy(std::begin(code), std::end(code), rom.begin() + 0x150);
+    uint8_t checksum = 0;
+    for (int i = 0x134; i < 0x14D; i++)
+        checksum = static_cast<uint8_t>(checksum - rom[i] - 1);
+    rom[0x14D] = checksum;
+    return rom;
+}
+
+// Record and replay `steps` steps of a ROM. With `destroyOpen` the writer is
+// never closed explicitly, so its destructor has to write the trailer and
+// detach the CPU trace.
+bool check(const std::string& name, const std::string& romPath, const std::string& tracePath, int steps,
+           bool destroyOpen, uint64_t& verified) {
+    auto gameboy = std::make_unique<GameBoy>();
+    if (!gameboy->loadROM(romPath))
+        return false;
+
+    // Short segments so the replay starts from keyframes taken mid-HALT too
+    auto writer = std::make_unique<DiffTraceWriter>(TraceWriterOptions(), 256);
+    if (!writer->open(tracePath, gameboy->getMemory()))
+        return false;
+    writer->attach(gameboy->getCPU().tracer());
+    for (int i = 0; i < steps; i++)
+        gameboy->step();
+    uint64_t written = 0;
+    if (!destroyOpen) {
+        if (!writer->close())
+            return false;
+        written = writer->recordsWritten();
+    }
+    writer.reset();
+    // Closing detached the CPU trace, so it must not reach the destroyed writer
+    for (int i = 0; i < 1000; i++)
+        gameboy->step();
+    gameboy->getCPU().tracer().flush();
+
+    ReplayResult result = TraceReplayer().run(tracePath);
+    if (result.diverged)
+        TraceReplayer::describe(result.divergence, std::cerr);
+    verified = result.recordsVerified;
+    std::cout << name << ": " << result.recordsVerified << " records verified in " << result.segments
+              << " segments" << (result.ok ? "" : " (FAILED)") << std::endl;
+    return result.ok && (destroyOpen || result.recordsVerified == written);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int steps = 200000;
+    std::vector<std::string> roms;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--steps" && i + 1 < argc)
+            steps = std::atoi(argv[++i]);
+        else
+            roms.push_back(arg);
+    }
+
+    namespace fs = std::filesystem;
+    fs::path directory = fs::temp_directory_path();
+    std::string suffix = std::to_string(static_cast<long>(::getpid()));
+    fs::path haltPath = directory / ("replay_check_halt_" + suffix + ".gb");
+    fs::path tracePath = directory / ("replay_check_" + suffix + ".trace");
+
+    std::vector<uint8_t> rom = haltRom();
+    std::ofstream(haltPath, std::ios::binary).write(reinterpret_cast<const char*>(rom.data()),
+                                                   static_cast<std::streamsize>(rom.size()));
+
+    uint64_t closed = 0, destroyed = 0, verified = 0;
+    bool ok = check("halt", haltPath.string(), tracePath.string(), steps, false, closed);
+    ok = check("halt (closed by destructor)", haltPath.string(), tracePath.string(), steps, true, destroyed) && ok;
+    ok = ok && closed == destroyed;
+    for (const std::string& path : roms)
+        ok = check(fs::path(path).filename().string(), path, tracePath.string(), steps, false, verified) && ok;
+
+    fs::remove(haltPath);
+    fs::remove(tracePath);
+    return ok ? 0 : 1;
+}